@@ -0,0 +1,128 @@
+/*
+ * SoftGLRender
+ * @author 	: keith@robot9.me
+ *
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "Render/Software/SamplerSoft.h"
+
+using namespace SoftGL;
+
+// each case runs this many times, best time reported
+#define BENCH_REPEAT 3
+// depth test passes over whole buffer, depth decreases every pass so all samples are written
+#define BENCH_DEPTH_PASSES 8
+
+typedef BaseSampler<RGBA> SamplerRGBA;
+
+// L: compile time layout index, AnyIndex is the runtime layout switch
+template<typename L, typename W>
+static double benchBilinear(Buffer<RGBA> *buffer, int sampleCnt, double &checksum) {
+  glm::vec4 acc(0.f);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < sampleCnt; i++) {
+    // coherent walk with rotation, like a textured surface, covers wrapped area as well
+    float u = (float) ((i * 7) % 4096) / 4096.f * 1.3f - 0.1f;
+    float v = (float) ((i / 4096) * 3 % 4096) / 4096.f * 1.3f - 0.1f;
+    glm::vec2 uv(u + v * 0.2f, v - u * 0.1f);
+    acc += SamplerRGBA::sampleBilinear<L, W>(buffer, uv, glm::ivec2(0), glm::vec4(0.f));
+  }
+  auto end = std::chrono::steady_clock::now();
+  checksum = acc.x + acc.y + acc.z + acc.w;
+  return std::chrono::duration<double, std::nano>(end - start).count() / sampleCnt;
+}
+
+// 32x32 raster blocks of 2x2 quads, test & write like RendererSoft::processDepthTest
+template<typename L, typename D>
+static double benchDepthTest(Buffer<D> *buffer, double &checksum) {
+  int width = (int) buffer->getWidth();
+  int height = (int) buffer->getHeight();
+  size_t passed = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int p = 0; p < BENCH_DEPTH_PASSES; p++) {
+    float z = 1.f - (float) p / (float) BENCH_DEPTH_PASSES;
+    for (int by = 0; by < height; by += 32) {
+      for (int bx = 0; bx < width; bx += 32) {
+        for (int y = by; y < by + 32; y += 2) {
+          for (int x = bx; x < bx + 32; x += 2) {
+            for (int k = 0; k < 4; k++) {
+              D *ptr = buffer->template get<L>(x + (k & 1), y + (k >> 1));
+              if (!ptr) {
+                continue;
+              }
+              auto *zPtr = (float *) ptr;
+              float depth = z + (float) ((x ^ y) & 7) * 1e-4f;
+              if (depth < *zPtr) {
+                *zPtr = depth;
+                passed++;
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  checksum = (double) passed;
+  return std::chrono::duration<double, std::nano>(end - start).count()
+      / ((double) BENCH_DEPTH_PASSES * width * height);
+}
+
+template<typename L, typename W>
+static void runBilinear(Buffer<RGBA> *buffer, const char *layoutName, const char *wrapName, int sampleCnt) {
+  double sumAny = 0, sumTyped = 0;
+  double timeAny = 1e9, timeTyped = 1e9;
+  for (int r = 0; r < BENCH_REPEAT; r++) {
+    timeAny = std::min(timeAny, benchBilinear<AnyIndex, W>(buffer, sampleCnt, sumAny));
+    timeTyped = std::min(timeTyped, benchBilinear<L, W>(buffer, sampleCnt, sumTyped));
+  }
+  printf("bilinear  %-6s %-6s %4zux%-4zu  switch %6.2f ns  typed %6.2f ns  %s\n", layoutName, wrapName,
+         buffer->getWidth(), buffer->getHeight(), timeAny, timeTyped, sumAny == sumTyped ? "" : "(MISMATCH)");
+}
+
+template<typename L, typename D>
+static void runDepthTest(int size, BufferLayout layout, const char *layoutName, const char *samplesName) {
+  auto buffer = Buffer<D>::makeLayout(size, size, layout);
+  double sumAny = 0, sumTyped = 0;
+  double timeAny = 1e9, timeTyped = 1e9;
+  for (int r = 0; r < BENCH_REPEAT; r++) {
+    buffer->setAll(D(1.f));
+    timeAny = std::min(timeAny, benchDepthTest<AnyIndex>(buffer.get(), sumAny));
+    buffer->setAll(D(1.f));
+    timeTyped = std::min(timeTyped, benchDepthTest<L>(buffer.get(), sumTyped));
+  }
+  printf("depth     %-6s %-6s %4dx%-4d  switch %6.2f ns  typed %6.2f ns  %s\n", layoutName, samplesName,
+         size, size, timeAny, timeTyped, sumAny == sumTyped ? "" : "(MISMATCH)");
+}
+
+template<typename L>
+static void runLayout(BufferLayout layout, const char *name, int texSize, int sampleCnt, int depthSize) {
+  auto texture = Buffer<RGBA>::makeLayout(texSize, texSize, layout);
+  for (int y = 0; y < texSize; y++) {
+    for (int x = 0; x < texSize; x++) {
+      texture->set(x, y, RGBA((x * 13) & 255, (y * 7) & 255, (x ^ y) & 255, 255));
+    }
+  }
+  runBilinear<L, WrapRepeatPOT>(texture.get(), name, "repeat", sampleCnt);
+  runBilinear<L, WrapClampEdge>(texture.get(), name, "clamp", sampleCnt);
+  runBilinear<L, WrapMirrorPOT>(texture.get(), name, "mirror", sampleCnt);
+
+  // depth attachment, single sample & 4x msaa (vec4 per pixel)
+  runDepthTest<L, float>(depthSize, layout, name, "1x");
+  runDepthTest<L, glm::vec4>(depthSize, layout, name, "4x");
+}
+
+// usage: BenchLayout [texture size] [bilinear samples] [depth buffer size], sizes power of two
+int main(int argc, char **argv) {
+  int texSize = argc > 1 ? atoi(argv[1]) : 256;
+  int sampleCnt = argc > 2 ? atoi(argv[2]) : 2000000;
+  int depthSize = argc > 3 ? atoi(argv[3]) : 1024;
+  printf("per sample / per pixel time, switch: runtime layout dispatch, typed: compile time layout\n");
+  runLayout<LinearIndex>(Layout_Linear, "linear", texSize, sampleCnt, depthSize);
+  runLayout<TiledIndex>(Layout_Tiled, "tiled", texSize, sampleCnt, depthSize);
+  runLayout<MortonIndex>(Layout_Morton, "morton", texSize, sampleCnt, depthSize);
+  return 0;
+}
@@ -0,0 +1,158 @@
+/*
+ * SoftGLRender
+ * @author 	: keith@robot9.me
+ *
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+#include "Base/ThreadPool.h"
+
+using namespace SoftGL;
+
+// batches of tiny tasks pushed from a non-worker thread, waited with waitTasksFinish
+#define BENCH_BATCHES 200
+#define BENCH_BATCH_TASKS 1024
+
+// raster block task capture (pointers, edge equations, block rect), larger than a pointer capture
+struct BlockCapture {
+  void *ptr[3];
+  float edges[6];
+  float scale;
+  int x, y;
+};
+
+// ThreadPool before inline tasks & lock-free rings: std::function queue under one mutex,
+// idle workers yield in a loop. kept here as baseline only
+class BaselineThreadPool {
+ public:
+  explicit BaselineThreadPool(size_t threadCnt) : threadCnt_(threadCnt), threads_(new std::thread[threadCnt]) {
+    for (size_t i = 0; i < threadCnt_; i++) {
+      threads_[i] = std::thread(&BaselineThreadPool::taskWorker, this, i);
+    }
+  }
+
+  ~BaselineThreadPool() {
+    waitTasksFinish();
+    running_ = false;
+    for (size_t i = 0; i < threadCnt_; i++) {
+      threads_[i].join();
+    }
+  }
+
+  template<typename F>
+  void pushTask(const F &task) {
+    tasksCnt_++;
+    const std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push(std::function<void(size_t)>(task));
+  }
+
+  void waitTasksFinish() const {
+    while (tasksCnt_ != 0) {
+      std::this_thread::yield();
+    }
+  }
+
+ private:
+  bool popTask(std::function<void(size_t)> &task) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (tasks_.empty()) {
+      return false;
+    }
+    task = std::move(tasks_.front());
+    tasks_.pop();
+    return true;
+  }
+
+  void taskWorker(size_t threadId) {
+    while (running_) {
+      std::function<void(size_t)> task;
+      if (popTask(task)) {
+        task(threadId);
+        tasksCnt_--;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+ private:
+  std::mutex mutex_;
+  std::atomic<bool> running_{true};
+  size_t threadCnt_ = 0;
+  std::unique_ptr<std::thread[]> threads_;
+  std::queue<std::function<void(size_t)>> tasks_;
+  std::atomic<size_t> tasksCnt_{0};
+};
+
+struct BenchResult {
+  double compute = 0;
+  double small = 0;
+  double large = 0;
+};
+
+template<typename P, typename F>
+static double measure(P &pool, const F &push) {
+  auto start = std::chrono::steady_clock::now();
+  for (int b = 0; b < BENCH_BATCHES; b++) {
+    for (int t = 0; t < BENCH_BATCH_TASKS; t++) {
+      push(t);
+    }
+    pool.waitTasksFinish();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / (BENCH_BATCHES * BENCH_BATCH_TASKS);
+}
+
+template<typename P>
+static BenchResult measurePool(P &pool) {
+  BenchResult ret;
+  std::atomic<uint64_t> sink(0);
+  BlockCapture block{};
+
+  // ~200 multiply-adds per task, scaling with thread count
+  ret.compute = measure(pool, [&](int t) {
+    pool.pushTask([&sink, t](size_t) {
+      uint64_t x = t;
+      for (int k = 0; k < 200; k++) {
+        x = x * 6364136223846793005ULL + 1;
+      }
+      sink += x & 1;
+    });
+  });
+
+  // empty tasks, push & dispatch overhead only
+  ret.small = measure(pool, [&](int t) {
+    pool.pushTask([&sink, t](size_t) { sink += t & 1; });
+  });
+  ret.large = measure(pool, [&](int t) {
+    pool.pushTask([&sink, block, t](size_t) { sink += (t + block.x) & 1; });
+  });
+  return ret;
+}
+
+// usage: BenchThreadPool [max threads], thread count doubles from 1
+int main(int argc, char **argv) {
+  size_t maxThreads = argc > 1 ? (size_t) std::max(atoi(argv[1]), 1) : 64;
+  printf("cpus: %u, %d batches x %d tasks, ns/task ThreadPool / baseline (std::function + mutex)\n",
+         std::thread::hardware_concurrency(), BENCH_BATCHES, BENCH_BATCH_TASKS);
+  printf("threads         compute           small capture           block capture\n");
+
+  for (size_t threadCnt = 1; threadCnt <= maxThreads; threadCnt *= 2) {
+    BenchResult current, baseline;
+    {
+      ThreadPool pool(threadCnt);
+      current = measurePool(pool);
+    }
+    {
+      BaselineThreadPool pool(threadCnt);
+      baseline = measurePool(pool);
+    }
+    printf("%7zu  %7.1f / %7.1f  %9.1f / %9.1f  %9.1f / %9.1f\n", threadCnt,
+           current.compute, baseline.compute, current.small, baseline.small, current.large, baseline.large);
+  }
+  return 0;
+}
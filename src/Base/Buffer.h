@@ -13,27 +13,96 @@ namespace SoftGL {
 
 enum BufferLayout {
   Layout_Linear,
-  Layout_Tiled,
-  Layout_Morton,
+  Layout_Tiled,   // row-major 32x32 tiles, same as RendererSoft raster block
+  Layout_Morton,  // 32x32 tiles, z-order inside tile
 };
 
+#define BUFFER_TILE_BITS 5
+#define BUFFER_TILE_SIZE (1 << BUFFER_TILE_BITS)
+
+// pixel index of each layout, innerWidth is padded to tile size for tiled layouts.
+// adjacent(x): pixel (x + 1, y) directly follows (x, y) in memory
+struct LinearIndex {
+  static inline size_t get(size_t x, size_t y, size_t innerWidth) {
+    return x + y * innerWidth;
+  }
+
+  static inline bool adjacent(size_t x) {
+    return true;
+  }
+};
+
+struct TiledIndex {
+  static inline size_t get(size_t x, size_t y, size_t innerWidth) {
+    size_t tileX = x >> BUFFER_TILE_BITS;
+    size_t tileY = y >> BUFFER_TILE_BITS;
+    size_t inTileX = x & (BUFFER_TILE_SIZE - 1);
+    size_t inTileY = y & (BUFFER_TILE_SIZE - 1);
+    return (tileY * innerWidth << BUFFER_TILE_BITS) + (tileX << BUFFER_TILE_BITS << BUFFER_TILE_BITS)
+        + (inTileY << BUFFER_TILE_BITS) + inTileX;
+  }
+
+  static inline bool adjacent(size_t x) {
+    return (x & (BUFFER_TILE_SIZE - 1)) != BUFFER_TILE_SIZE - 1;
+  }
+};
+
+struct MortonIndex {
+  /**
+   * Ref: https://gist.github.com/JarkkoPFC/0e4e599320b0cc7ea92df45fb416d79a
+   */
+  static inline uint16_t encode16_morton2(uint8_t x_, uint8_t y_) {
+    uint32_t res = x_ | (uint32_t(y_) << 16);
+    res = (res | (res << 4)) & 0x0f0f0f0f;
+    res = (res | (res << 2)) & 0x33333333;
+    res = (res | (res << 1)) & 0x55555555;
+    return uint16_t(res | (res >> 15));
+  }
+
+  static inline size_t get(size_t x, size_t y, size_t innerWidth) {
+    size_t tileX = x >> BUFFER_TILE_BITS;
+    size_t tileY = y >> BUFFER_TILE_BITS;
+    uint8_t inTileX = x & (BUFFER_TILE_SIZE - 1);
+    uint8_t inTileY = y & (BUFFER_TILE_SIZE - 1);
+    return (tileY * innerWidth << BUFFER_TILE_BITS) + (tileX << BUFFER_TILE_BITS << BUFFER_TILE_BITS)
+        + encode16_morton2(inTileX, inTileY);
+  }
+
+  static inline bool adjacent(size_t x) {
+    return (x & 1) == 0;
+  }
+};
+
+// layout known only at runtime, resolved per access by Buffer::convertIndex
+struct AnyIndex {
+  static inline bool adjacent(size_t x) {
+    return false;
+  }
+};
+
+// 2D pixel buffer, layout is chosen at creation and dispatched inline (no virtual call per pixel)
 template<typename T>
 class Buffer {
  public:
+  explicit Buffer(BufferLayout layout = Layout_Linear) : layout_(layout) {}
+
   static std::shared_ptr<Buffer<T>> makeDefault(size_t w, size_t h);
   static std::shared_ptr<Buffer<T>> makeLayout(size_t w, size_t h, BufferLayout layout);
 
-  virtual void initLayout() {
-    innerWidth_ = width_;
-    innerHeight_ = height_;
-  }
-
-  virtual inline size_t convertIndex(size_t x, size_t y) const {
-    return x + y * innerWidth_;
+  inline size_t convertIndex(size_t x, size_t y) const {
+    switch (layout_) {
+      case Layout_Tiled:
+        return TiledIndex::get(x, y, innerWidth_);
+      case Layout_Morton:
+        return MortonIndex::get(x, y, innerWidth_);
+      default:
+        break;
+    }
+    return LinearIndex::get(x, y, innerWidth_);
   }
 
-  virtual BufferLayout getLayout() const {
-    return Layout_Linear;
+  inline BufferLayout getLayout() const {
+    return layout_;
   }
 
   void create(size_t w, size_t h, const uint8_t *data = nullptr) {
@@ -44,13 +113,19 @@ class Buffer {
       width_ = w;
       height_ = h;
 
-      initLayout();
+      if (layout_ == Layout_Linear) {
+        innerWidth_ = width_;
+        innerHeight_ = height_;
+      } else {
+        innerWidth_ = (width_ + BUFFER_TILE_SIZE - 1) & ~((size_t) BUFFER_TILE_SIZE - 1);
+        innerHeight_ = (height_ + BUFFER_TILE_SIZE - 1) & ~((size_t) BUFFER_TILE_SIZE - 1);
+      }
       dataSize_ = innerWidth_ * innerHeight_;
-      data_ = MemoryUtils::makeBuffer<T>(dataSize_, data);
+      data_ = data ? MemoryUtils::makeBuffer<T>(dataSize_, data) : MemoryUtils::makeLargeBuffer<T>(dataSize_);
     }
   }
 
-  virtual void destroy() {
+  void destroy() {
     width_ = 0;
     height_ = 0;
     innerWidth_ = 0;
@@ -83,31 +158,63 @@ class Buffer {
     return height_;
   }
 
+  // L: LinearIndex / TiledIndex / MortonIndex matching getLayout(), so hot loops dispatched once
+  // on the layout get straight-line address math. AnyIndex switches on layout per access
+  template<typename L = AnyIndex>
   inline T *get(size_t x, size_t y) {
     T *ptr = data_.get();
     if (ptr != nullptr && x < width_ && y < height_) {
-      return &ptr[convertIndex(x, y)];
+      return &ptr[indexOf(x, y, L())];
     }
     return nullptr;
   }
 
+  template<typename L = AnyIndex>
   inline void set(size_t x, size_t y, const T &pixel) {
     T *ptr = data_.get();
     if (ptr != nullptr && x < width_ && y < height_) {
-      ptr[convertIndex(x, y)] = pixel;
+      ptr[indexOf(x, y, L())] = pixel;
     }
   }
 
-  void copyRawDataTo(T *out, bool flip_y = false) const {
+  // copy pixels in row order (width x height, without padding) whatever the layout
+  void copyLinearDataTo(T *out, bool flip_y = false) const {
     T *ptr = data_.get();
-    if (ptr != nullptr) {
-      if (!flip_y) {
-        memcpy(out, ptr, dataSize_ * sizeof(T));
-      } else {
-        for (int i = 0; i < innerHeight_; i++) {
-          memcpy(out + innerWidth_ * i, ptr + innerWidth_ * (innerHeight_ - 1 - i),
-                 innerWidth_ * sizeof(T));
+    if (ptr == nullptr) {
+      return;
+    }
+    for (size_t y = 0; y < height_; y++) {
+      T *dst = out + width_ * (flip_y ? (height_ - 1 - y) : y);
+      if (layout_ != Layout_Morton) {
+        // contiguous row, or row runs within tiles
+        size_t run = layout_ == Layout_Linear ? width_ : BUFFER_TILE_SIZE;
+        for (size_t x = 0; x < width_; x += run) {
+          memcpy(dst + x, ptr + convertIndex(x, y), std::min(run, width_ - x) * sizeof(T));
         }
+        continue;
+      }
+      for (size_t x = 0; x < width_; x++) {
+        dst[x] = ptr[MortonIndex::get(x, y, innerWidth_)];
+      }
+    }
+  }
+
+  void copyLinearDataFrom(const T *in) {
+    T *ptr = data_.get();
+    if (ptr == nullptr) {
+      return;
+    }
+    for (size_t y = 0; y < height_; y++) {
+      const T *src = in + width_ * y;
+      if (layout_ != Layout_Morton) {
+        size_t run = layout_ == Layout_Linear ? width_ : BUFFER_TILE_SIZE;
+        for (size_t x = 0; x < width_; x += run) {
+          memcpy(ptr + convertIndex(x, y), src + x, std::min(run, width_ - x) * sizeof(T));
+        }
+        continue;
+      }
+      for (size_t x = 0; x < width_; x++) {
+        ptr[MortonIndex::get(x, y, innerWidth_)] = src[x];
       }
     }
   }
@@ -128,120 +235,66 @@ class Buffer {
     }
   }
 
- protected:
-  size_t width_ = 0;
-  size_t height_ = 0;
-  size_t innerWidth_ = 0;
-  size_t innerHeight_ = 0;
-  std::shared_ptr<T> data_ = nullptr;
-  size_t dataSize_ = 0;
-};
-
-template<typename T>
-class TiledBuffer : public Buffer<T> {
- public:
-
-  void initLayout() override {
-    tileWidth_ = (this->width_ + tileSize_ - 1) / tileSize_;
-    tileHeight_ = (this->height_ + tileSize_ - 1) / tileSize_;
-    this->innerWidth_ = tileWidth_ * tileSize_;
-    this->innerHeight_ = tileHeight_ * tileSize_;
-  }
-
-  inline size_t convertIndex(size_t x, size_t y) const override {
-    uint16_t tileX = x >> bits_;              // x / tileSize_
-    uint16_t tileY = y >> bits_;              // y / tileSize_
-    uint16_t inTileX = x & (tileSize_ - 1);   // x % tileSize_
-    uint16_t inTileY = y & (tileSize_ - 1);   // y % tileSize_
-
-    return ((tileY * tileWidth_ + tileX) << bits_ << bits_) + (inTileY << bits_) + inTileX;
-  }
-
-  BufferLayout getLayout() const override {
-    return Layout_Tiled;
+  void setRect(size_t x, size_t y, size_t w, size_t h, T val) const {
+    if (x == 0 && y == 0 && w >= width_ && h >= height_) {
+      setAll(val);
+      return;
+    }
+    T *ptr = data_.get();
+    if (ptr != nullptr) {
+      size_t xEnd = std::min(x + w, width_);
+      size_t yEnd = std::min(y + h, height_);
+      for (size_t py = y; py < yEnd; py++) {
+        if (layout_ == Layout_Linear) {
+          T *row = ptr + convertIndex(x, py);
+          std::fill(row, row + (xEnd - x), val);
+          continue;
+        }
+        if (layout_ == Layout_Tiled) {
+          // contiguous within a tile row
+          for (size_t px = x; px < xEnd;) {
+            size_t runEnd = std::min(xEnd, (px | (BUFFER_TILE_SIZE - 1)) + 1);
+            T *run = ptr + convertIndex(px, py);
+            std::fill(run, run + (runEnd - px), val);
+            px = runEnd;
+          }
+          continue;
+        }
+        for (size_t px = x; px < xEnd; px++) {
+          ptr[convertIndex(px, py)] = val;
+        }
+      }
+    }
   }
 
  private:
-  const static int tileSize_ = 4;   // 4 x 4
-  const static int bits_ = 2;       // tileSize_ = 2^bits_
-  size_t tileWidth_ = 0;
-  size_t tileHeight_ = 0;
-};
-
-template<typename T>
-class MortonBuffer : public Buffer<T> {
- public:
-
-  void initLayout() override {
-    tileWidth_ = (this->width_ + tileSize_ - 1) / tileSize_;
-    tileHeight_ = (this->height_ + tileSize_ - 1) / tileSize_;
-    this->innerWidth_ = tileWidth_ * tileSize_;
-    this->innerHeight_ = tileHeight_ * tileSize_;
-  }
-
-  /**
-   * Ref: https://gist.github.com/JarkkoPFC/0e4e599320b0cc7ea92df45fb416d79a
-   */
-  static inline uint16_t encode16_morton2(uint8_t x_, uint8_t y_) {
-    uint32_t res = x_ | (uint32_t(y_) << 16);
-    res = (res | (res << 4)) & 0x0f0f0f0f;
-    res = (res | (res << 2)) & 0x33333333;
-    res = (res | (res << 1)) & 0x55555555;
-    return uint16_t(res | (res >> 15));
+  template<typename L>
+  inline size_t indexOf(size_t x, size_t y, L) const {
+    return L::get(x, y, innerWidth_);
   }
 
-  inline size_t convertIndex(size_t x, size_t y) const override {
-    uint16_t tileX = x >> bits_;              // x / tileSize_
-    uint16_t tileY = y >> bits_;              // y / tileSize_
-    uint16_t inTileX = x & (tileSize_ - 1);   // x % tileSize_
-    uint16_t inTileY = y & (tileSize_ - 1);   // y % tileSize_
-
-    uint16_t mortonIndex = encode16_morton2(inTileX, inTileY);
-
-    return ((tileY * tileWidth_ + tileX) << bits_ << bits_) + mortonIndex;
+  inline size_t indexOf(size_t x, size_t y, AnyIndex) const {
+    return convertIndex(x, y);
   }
 
-  BufferLayout getLayout() const override {
-    return Layout_Morton;
-  }
-
- private:
-  const static int tileSize_ = 32;  // 32 x 32
-  const static int bits_ = 5;       // tileSize_ = 2^bits_
-  size_t tileWidth_ = 0;
-  size_t tileHeight_ = 0;
+ protected:
+  BufferLayout layout_ = Layout_Linear;
+  size_t width_ = 0;
+  size_t height_ = 0;
+  size_t innerWidth_ = 0;
+  size_t innerHeight_ = 0;
+  std::shared_ptr<T> data_ = nullptr;
+  size_t dataSize_ = 0;
 };
 
 template<typename T>
 std::shared_ptr<Buffer<T>> Buffer<T>::makeDefault(size_t w, size_t h) {
-  std::shared_ptr<Buffer<T>> ret = nullptr;
-#if SOFTGL_TEXTURE_TILED
-  ret = std::make_shared<TiledBuffer<T>>();
-#elif SOFTGL_TEXTURE_MORTON
-  ret = std::make_shared<MortonBuffer<T>>();
-#else
-  ret = std::make_shared<Buffer<T>>();
-#endif
-  ret->create(w, h);
-  return ret;
+  return makeLayout(w, h, Layout_Linear);
 }
 
 template<typename T>
 std::shared_ptr<Buffer<T>> Buffer<T>::makeLayout(size_t w, size_t h, BufferLayout layout) {
-  std::shared_ptr<Buffer<T>> ret = nullptr;
-  switch (layout) {
-    case Layout_Tiled: {
-      ret = std::make_shared<TiledBuffer<T>>();
-    }
-    case Layout_Morton: {
-      ret = std::make_shared<MortonBuffer<T>>();
-    }
-    case Layout_Linear:
-    default: {
-      ret = std::make_shared<Buffer<T>>();
-    }
-  }
-
+  auto ret = std::make_shared<Buffer<T>>(layout);
   ret->create(w, h);
   return ret;
 }
@@ -0,0 +1,58 @@
+/*
+ * SoftGLRender
+ * @author 	: keith@robot9.me
+ *
+ */
+
+#pragma once
+
+#include <cstring>
+#include "GLMInc.h"
+#include <glm/gtc/packing.hpp>
+
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#include <immintrin.h>
+#define SOFTGL_F16C
+#endif
+
+namespace SoftGL {
+
+using RGBA32F = glm::vec4;
+
+// half float rgba pixel (8 bytes), converted from/to float4 with F16C
+// trivial default constructor, so it can be used in glm vector & union storage
+struct RGBA16F {
+  uint16_t r;
+  uint16_t g;
+  uint16_t b;
+  uint16_t a;
+
+  RGBA16F() = default;
+
+  explicit RGBA16F(float v) : RGBA16F(glm::vec4(v)) {}
+
+  explicit RGBA16F(const glm::vec4 &v) {
+#ifdef SOFTGL_F16C
+    __m128i h = _mm_cvtps_ph(_mm_setr_ps(v.x, v.y, v.z, v.w), _MM_FROUND_TO_NEAREST_INT);
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(&r), h);
+#else
+    uint64_t h = glm::packHalf4x16(v);
+    memcpy(&r, &h, sizeof(uint64_t));
+#endif
+  }
+
+  explicit operator glm::vec4() const {
+#ifdef SOFTGL_F16C
+    __m128 f = _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(&r)));
+    glm::vec4 ret;
+    _mm_storeu_ps(&ret.x, f);
+    return ret;
+#else
+    uint64_t h;
+    memcpy(&h, &r, sizeof(uint64_t));
+    return glm::unpackHalf4x16(h);
+#endif
+  }
+};
+
+}
@@ -102,4 +102,43 @@ void ImageUtils::convertFloatImage(RGBA *dst, float *src, uint32_t width, uint32
   }
 }
 
+void ImageUtils::convertHeatmapImage(RGBA *dst, float *src, uint32_t width, uint32_t height) {
+  // blue -> cyan -> green -> yellow -> red
+  static const glm::vec3 colorRamp[5] = {
+      {0.f, 0.f, 1.f},
+      {0.f, 1.f, 1.f},
+      {0.f, 1.f, 0.f},
+      {1.f, 1.f, 0.f},
+      {1.f, 0.f, 0.f},
+  };
+
+  float *srcPixel = src;
+
+  float valueMax = 0.f;
+  for (int i = 0; i < width * height; i++) {
+    valueMax = std::max(valueMax, *srcPixel);
+    srcPixel++;
+  }
+
+  srcPixel = src;
+  RGBA *dstPixel = dst;
+  for (int i = 0; i < width * height; i++) {
+    float value = *srcPixel;
+    glm::vec3 color(0.f);
+    // zero value keep black
+    if (value > 0.f && valueMax > 0.f) {
+      float t = glm::clamp(value / valueMax, 0.f, 1.f) * 4.f;
+      int idx = std::min((int) t, 3);
+      color = glm::mix(colorRamp[idx], colorRamp[idx + 1], t - (float) idx);
+    }
+    dstPixel->r = (uint8_t) (color.r * 255.f);
+    dstPixel->g = (uint8_t) (color.g * 255.f);
+    dstPixel->b = (uint8_t) (color.b * 255.f);
+    dstPixel->a = 255;
+
+    srcPixel++;
+    dstPixel++;
+  }
+}
+
 }
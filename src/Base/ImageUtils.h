@@ -18,6 +18,7 @@ class ImageUtils {
                          bool flipY);
 
   static void convertFloatImage(RGBA *dst, float *src, uint32_t width, uint32_t height);
+  static void convertHeatmapImage(RGBA *dst, float *src, uint32_t width, uint32_t height);
 };
 
 }
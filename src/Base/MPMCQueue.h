@@ -0,0 +1,97 @@
+/*
+ * SoftGLRender
+ * @author 	: keith@robot9.me
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace SoftGL {
+
+// bounded lock-free multi-producer multi-consumer ring (D. Vyukov), each cell carries a sequence number:
+// seq == pos: free for producer of pos, seq == pos + 1: ready for consumer of pos
+template<typename T, size_t Capacity>
+class MPMCQueue {
+  static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "capacity must be power of two");
+
+ public:
+  MPMCQueue() {
+    for (size_t i = 0; i < Capacity; i++) {
+      cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MPMCQueue(const MPMCQueue &) = delete;
+  MPMCQueue &operator=(const MPMCQueue &) = delete;
+
+  // return false if full, item not moved
+  bool tryPush(T &item) {
+    Cell *cell;
+    size_t pos = tail_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[pos & (Capacity - 1)];
+      size_t seq = cell->seq.load(std::memory_order_acquire);
+      intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+      if (diff == 0) {
+        if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->data = std::move(item);
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // return false if empty
+  bool tryPop(T &item) {
+    Cell *cell;
+    size_t pos = head_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[pos & (Capacity - 1)];
+      size_t seq = cell->seq.load(std::memory_order_acquire);
+      intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
+      if (diff == 0) {
+        if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+    item = std::move(cell->data);
+    cell->seq.store(pos + Capacity, std::memory_order_release);
+    return true;
+  }
+
+  // approximate, only a hint under concurrency
+  inline bool empty() const {
+    return head_.load(std::memory_order_relaxed) >= tail_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> seq;
+    T data;
+  };
+
+  // producer & consumer index on separate cache lines (padding, heap storage may not honor alignas in c++11)
+  std::atomic<size_t> head_{0};
+  char padding0_[64];
+  std::atomic<size_t> tail_{0};
+  char padding1_[64];
+  Cell cells_[Capacity];
+};
+
+}
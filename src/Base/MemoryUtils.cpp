@@ -0,0 +1,123 @@
+/*
+ * SoftGLRender
+ * @author 	: keith@robot9.me
+ *
+ */
+
+#include "MemoryUtils.h"
+#include "Platform.h"
+
+#if defined(PLATFORM_LINUX)
+#include <sys/mman.h>
+#elif defined(PLATFORM_WINDOWS)
+#include <windows.h>
+#endif
+
+namespace SoftGL {
+
+static std::atomic<int> hugePageMode_(HugePage_TRANSPARENT);
+static std::atomic<size_t> hugePageThreshold_(SOFTGL_HUGE_PAGE_THRESHOLD);
+
+void MemoryUtils::setHugePageMode(HugePageMode mode, size_t threshold) {
+  hugePageMode_ = mode;
+  hugePageThreshold_ = threshold;
+}
+
+HugePageMode MemoryUtils::getHugePageMode() {
+  return (HugePageMode) hugePageMode_.load();
+}
+
+#if defined(PLATFORM_LINUX)
+
+static inline size_t hugePageAlignedSize(size_t size) {
+  return (size + SOFTGL_HUGE_PAGE_SIZE - 1) & ~((size_t) SOFTGL_HUGE_PAGE_SIZE - 1);
+}
+
+// over-map by one huge page and trim head & tail, so the range starts on a huge page boundary
+static void *mapAligned(size_t size) {
+  size_t mapSize = size + SOFTGL_HUGE_PAGE_SIZE;
+  auto *base = (uint8_t *) mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) {
+    return nullptr;
+  }
+  size_t addr = ((size_t) base + SOFTGL_HUGE_PAGE_SIZE - 1) & ~((size_t) SOFTGL_HUGE_PAGE_SIZE - 1);
+  auto *ptr = (uint8_t *) addr;
+  if (ptr > base) {
+    munmap(base, ptr - base);
+  }
+  size_t tail = (base + mapSize) - (ptr + size);
+  if (tail > 0) {
+    munmap(ptr + size, tail);
+  }
+  return ptr;
+}
+
+void *MemoryUtils::hugePageMalloc(size_t size) {
+  HugePageMode mode = getHugePageMode();
+  if (mode == HugePage_OFF || size == 0 || size < hugePageThreshold_) {
+    return nullptr;
+  }
+  size_t alignedSize = hugePageAlignedSize(size);
+  void *ptr = nullptr;
+  if (mode == HugePage_EXPLICIT) {
+    ptr = mmap(nullptr, alignedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (ptr == MAP_FAILED) {
+      // no reserved pages (vm.nr_hugepages), use transparent huge pages
+      ptr = nullptr;
+    }
+  }
+  if (!ptr) {
+    ptr = mapAligned(alignedSize);
+    if (!ptr) {
+      LOGE("huge page alloc failed, size: %d", size);
+      return nullptr;
+    }
+    // hint only, fails if transparent huge pages are disabled
+    madvise(ptr, alignedSize, MADV_HUGEPAGE);
+  }
+  allocCounter().fetch_add(1, std::memory_order_relaxed);
+  return ptr;
+}
+
+void MemoryUtils::hugePageFree(void *ptr, size_t size) {
+  if (ptr) {
+    munmap(ptr, hugePageAlignedSize(size));
+  }
+}
+
+#elif defined(PLATFORM_WINDOWS)
+
+// large pages need SeLockMemoryPrivilege, there is no transparent mode
+void *MemoryUtils::hugePageMalloc(size_t size) {
+  if (getHugePageMode() != HugePage_EXPLICIT || size == 0 || size < hugePageThreshold_) {
+    return nullptr;
+  }
+  size_t pageSize = GetLargePageMinimum();
+  if (pageSize == 0) {
+    return nullptr;
+  }
+  size_t alignedSize = (size + pageSize - 1) / pageSize * pageSize;
+  void *ptr = VirtualAlloc(nullptr, alignedSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+  if (ptr) {
+    allocCounter().fetch_add(1, std::memory_order_relaxed);
+  }
+  return ptr;
+}
+
+void MemoryUtils::hugePageFree(void *ptr, size_t size) {
+  if (ptr) {
+    VirtualFree(ptr, 0, MEM_RELEASE);
+  }
+}
+
+#else
+
+void *MemoryUtils::hugePageMalloc(size_t size) {
+  return nullptr;
+}
+
+void MemoryUtils::hugePageFree(void *ptr, size_t size) {}
+
+#endif
+
+}
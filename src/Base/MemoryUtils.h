@@ -6,14 +6,31 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstring>
 #include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
 #include "Logger.h"
 
 #define SOFTGL_ALIGNMENT 32
+#define SOFTGL_ARENA_ALIGNMENT 64
+#define SOFTGL_ARENA_BLOCK_SIZE (64 * 1024)
+
+#define SOFTGL_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#define SOFTGL_HUGE_PAGE_THRESHOLD (4 * 1024 * 1024)
 
 namespace SoftGL {
 
+enum HugePageMode {
+  HugePage_OFF = 0,
+  HugePage_TRANSPARENT,   // 2MB aligned mapping with madvise(MADV_HUGEPAGE), linux only
+  HugePage_EXPLICIT,      // reserved huge pages (MAP_HUGETLB / MEM_LARGE_PAGES), fallback to transparent
+};
+
 class MemoryUtils {
  public:
 
@@ -29,6 +46,7 @@ class MemoryUtils {
       LOGE("failed to malloc with size: %d", size);
       return nullptr;
     }
+    allocCounter().fetch_add(1, std::memory_order_relaxed);
     size_t addr = (size_t) data + extra;
     void *alignedPtr = (void *) (addr - (addr % alignment));
     *((void **) alignedPtr - 1) = data;
@@ -65,9 +83,196 @@ class MemoryUtils {
     if (data != nullptr) {
       return std::shared_ptr<T>((T *) data, [](const T *ptr) {});
     } else {
+      allocCounter().fetch_add(1, std::memory_order_relaxed);
       return std::shared_ptr<T>(new T[elemCnt], [](const T *ptr) { delete[] ptr; });
     }
   }
+
+  // buffer of trivial elements (not constructed), backed by huge pages if size reaches the threshold,
+  // falls back to makeBuffer when huge pages are off or unavailable
+  template<typename T>
+  static std::shared_ptr<T> makeLargeBuffer(size_t elemCnt) {
+    size_t size = elemCnt * sizeof(T);
+    void *ptr = hugePageMalloc(size);
+    if (ptr == nullptr) {
+      return makeBuffer<T>(elemCnt);
+    }
+    return std::shared_ptr<T>((T *) ptr, [size](const T *ptr) { hugePageFree((void *) ptr, size); });
+  }
+
+  // applies to later allocations, default is HugePage_TRANSPARENT
+  static void setHugePageMode(HugePageMode mode, size_t threshold = SOFTGL_HUGE_PAGE_THRESHOLD);
+  static HugePageMode getHugePageMode();
+
+  // nullptr if size below threshold or huge pages unavailable
+  static void *hugePageMalloc(size_t size);
+  static void hugePageFree(void *ptr, size_t size);
+
+  // number of heap allocations made by MemoryUtils (arena blocks included),
+  // used to check that steady-state frames do not allocate
+  static size_t getAllocCount() {
+    return allocCounter().load(std::memory_order_relaxed);
+  }
+
+ private:
+  static std::atomic<size_t> &allocCounter() {
+    static std::atomic<size_t> counter(0);
+    return counter;
+  }
+};
+
+// linear (bump) allocator for transient data, everything is released at once by reset().
+// grows with chained blocks, reset() merges them into one block that fits the peak usage,
+// so a workload repeated every frame stops allocating after the first frames.
+class LinearArena {
+ public:
+  explicit LinearArena(size_t blockSize = SOFTGL_ARENA_BLOCK_SIZE) : blockSize_(blockSize) {}
+
+  LinearArena(LinearArena &&o) noexcept
+      : blockSize_(o.blockSize_), blocks_(std::move(o.blocks_)), offset_(o.offset_) {
+    o.blocks_.clear();
+    o.offset_ = 0;
+  }
+
+  LinearArena(const LinearArena &) = delete;
+  LinearArena &operator=(const LinearArena &) = delete;
+
+  ~LinearArena() {
+    release();
+  }
+
+  // uninitialized memory, valid until next reset()
+  void *alloc(size_t size, size_t alignment = SOFTGL_ALIGNMENT) {
+    if (size == 0) {
+      return nullptr;
+    }
+    if ((alignment & (alignment - 1)) != 0 || alignment > SOFTGL_ARENA_ALIGNMENT) {
+      LOGE("arena alloc failed, invalid alignment: %d", alignment);
+      return nullptr;
+    }
+    size_t offset = (offset_ + alignment - 1) & ~(alignment - 1);
+    if (blocks_.empty() || offset + size > blocks_.back().size) {
+      if (!newBlock(std::max(size, blockSize_))) {
+        return nullptr;
+      }
+      offset = 0;
+    }
+    offset_ = offset + size;
+    return blocks_.back().data + offset;
+  }
+
+  template<typename T>
+  T *allocArray(size_t elemCnt) {
+    return static_cast<T *>(alloc(elemCnt * sizeof(T), std::max(alignof(T), (size_t) SOFTGL_ALIGNMENT)));
+  }
+
+  void reset() {
+    if (blocks_.size() > 1) {
+      size_t total = 0;
+      for (auto &block : blocks_) {
+        total += block.size;
+      }
+      release();
+      newBlock(total);
+    }
+    offset_ = 0;
+  }
+
+  void release() {
+    for (auto &block : blocks_) {
+      MemoryUtils::alignedFree(block.data);
+    }
+    blocks_.clear();
+    offset_ = 0;
+  }
+
+  size_t getCapacity() const {
+    size_t total = 0;
+    for (auto &block : blocks_) {
+      total += block.size;
+    }
+    return total;
+  }
+
+ private:
+  bool newBlock(size_t size) {
+    auto *data = (uint8_t *) MemoryUtils::alignedMalloc(size, SOFTGL_ARENA_ALIGNMENT);
+    if (!data) {
+      return false;
+    }
+    blocks_.push_back({data, size});
+    return true;
+  }
+
+ private:
+  struct Block {
+    uint8_t *data;
+    size_t size;
+  };
+
+  size_t blockSize_;
+  std::vector<Block> blocks_;
+  size_t offset_ = 0;   // in last block
+};
+
+// growable array on a LinearArena, for trivially copyable elements.
+// storage left behind by growth is reclaimed with the arena, call bind() again after arena reset
+template<typename T>
+class ArenaVector {
+  static_assert(std::is_trivially_copyable<T>::value, "element must be trivially copyable");
+
+ public:
+  void bind(LinearArena *arena) {
+    arena_ = arena;
+    data_ = nullptr;
+    size_ = 0;
+    capacity_ = 0;
+  }
+
+  void reserve(size_t cnt) {
+    if (cnt <= capacity_) {
+      return;
+    }
+    T *data = arena_->allocArray<T>(cnt);
+    if (size_ > 0) {
+      memcpy(data, data_, size_ * sizeof(T));
+    }
+    data_ = data;
+    capacity_ = cnt;
+  }
+
+  void resize(size_t cnt) {
+    reserve(cnt);
+    for (size_t i = size_; i < cnt; i++) {
+      new(data_ + i) T();
+    }
+    size_ = cnt;
+  }
+
+  T &emplace_back() {
+    if (size_ == capacity_) {
+      reserve(std::max((size_t) 16, capacity_ * 2));
+    }
+    new(data_ + size_) T();
+    return data_[size_++];
+  }
+
+  inline void clear() { size_ = 0; }
+  inline size_t size() const { return size_; }
+  inline bool empty() const { return size_ == 0; }
+
+  inline T &operator[](size_t idx) { return data_[idx]; }
+  inline const T &operator[](size_t idx) const { return data_[idx]; }
+  inline T &back() { return data_[size_ - 1]; }
+
+  inline T *begin() { return data_; }
+  inline T *end() { return data_ + size_; }
+
+ private:
+  LinearArena *arena_ = nullptr;
+  T *data_ = nullptr;
+  size_t size_ = 0;
+  size_t capacity_ = 0;
 };
 
 }
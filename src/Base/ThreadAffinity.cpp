@@ -0,0 +1,150 @@
+/*
+ * SoftGLRender
+ * @author 	: keith@robot9.me
+ *
+ */
+
+#include "ThreadAffinity.h"
+#include "Platform.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+#if defined(PLATFORM_LINUX)
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#elif defined(PLATFORM_WINDOWS)
+#include <windows.h>
+#endif
+
+namespace SoftGL {
+
+#if defined(PLATFORM_LINUX)
+
+// parse sysfs cpu list, e.g. "0-3,8-11"
+static std::vector<int> parseCpuList(const std::string &str) {
+  std::vector<int> ret;
+  size_t pos = 0;
+  while (pos < str.size()) {
+    size_t end = str.find(',', pos);
+    if (end == std::string::npos) {
+      end = str.size();
+    }
+    std::string range = str.substr(pos, end - pos);
+    size_t dash = range.find('-');
+    int first = atoi(range.c_str());
+    int last = (dash == std::string::npos) ? first : atoi(range.c_str() + dash + 1);
+    for (int cpu = first; cpu <= last; cpu++) {
+      ret.push_back(cpu);
+    }
+    pos = end + 1;
+  }
+  return ret;
+}
+
+static std::vector<int> getNodeCpuList(int numaNode) {
+  std::ifstream file("/sys/devices/system/node/node" + std::to_string(numaNode) + "/cpulist");
+  std::string line;
+  if (!file.is_open() || !std::getline(file, line)) {
+    LOGE("get cpu list of numa node %d failed", numaNode);
+    return {};
+  }
+  return parseCpuList(line);
+}
+
+std::vector<int> ThreadAffinity::getCpuList(int numaNode) {
+  std::vector<int> ret;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+    return ret;
+  }
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (CPU_ISSET(cpu, &set)) {
+      ret.push_back(cpu);
+    }
+  }
+
+  if (numaNode >= 0) {
+    std::vector<int> nodeCpus = getNodeCpuList(numaNode);
+    ret.erase(std::remove_if(ret.begin(), ret.end(), [&](int cpu) {
+      return std::find(nodeCpus.begin(), nodeCpus.end(), cpu) == nodeCpus.end();
+    }), ret.end());
+  }
+  return ret;
+}
+
+bool ThreadAffinity::setCurrentThreadCpus(const std::vector<int> &cpus) {
+  if (cpus.empty()) {
+    return false;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    CPU_SET(cpu, &set);
+  }
+  if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+    LOGE("set thread affinity failed");
+    return false;
+  }
+  return true;
+}
+
+#elif defined(PLATFORM_WINDOWS)
+
+// only first processor group (64 cpus) is handled
+std::vector<int> ThreadAffinity::getCpuList(int numaNode) {
+  std::vector<int> ret;
+  DWORD_PTR processMask = 0, systemMask = 0;
+  if (!GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask)) {
+    return ret;
+  }
+  if (numaNode >= 0) {
+    ULONGLONG nodeMask = 0;
+    if (!GetNumaNodeProcessorMask((UCHAR) numaNode, &nodeMask)) {
+      LOGE("get cpu list of numa node %d failed", numaNode);
+      return ret;
+    }
+    processMask &= (DWORD_PTR) nodeMask;
+  }
+  for (int cpu = 0; cpu < (int) sizeof(DWORD_PTR) * 8; cpu++) {
+    if (processMask & ((DWORD_PTR) 1 << cpu)) {
+      ret.push_back(cpu);
+    }
+  }
+  return ret;
+}
+
+bool ThreadAffinity::setCurrentThreadCpus(const std::vector<int> &cpus) {
+  DWORD_PTR mask = 0;
+  for (int cpu : cpus) {
+    if (cpu < (int) sizeof(DWORD_PTR) * 8) {
+      mask |= (DWORD_PTR) 1 << cpu;
+    }
+  }
+  if (mask == 0) {
+    return false;
+  }
+  if (SetThreadAffinityMask(GetCurrentThread(), mask) == 0) {
+    LOGE("set thread affinity failed");
+    return false;
+  }
+  return true;
+}
+
+#else
+
+std::vector<int> ThreadAffinity::getCpuList(int numaNode) {
+  return {};
+}
+
+bool ThreadAffinity::setCurrentThreadCpus(const std::vector<int> &cpus) {
+  return false;
+}
+
+#endif
+
+}
@@ -0,0 +1,23 @@
+/*
+ * SoftGLRender
+ * @author 	: keith@robot9.me
+ *
+ */
+
+#pragma once
+
+#include <vector>
+
+namespace SoftGL {
+
+// cpu & numa topology query and thread pinning, no-op on unsupported platforms
+class ThreadAffinity {
+ public:
+  // cpus allowed for this process, only those of numaNode if numaNode >= 0. empty if unknown
+  static std::vector<int> getCpuList(int numaNode = -1);
+
+  // restrict calling thread to cpus
+  static bool setCurrentThreadCpus(const std::vector<int> &cpus);
+};
+
+}
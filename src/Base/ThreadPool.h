@@ -6,65 +6,465 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
-#include <functional>
-#include <iostream>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
+#include <type_traits>
+#include <vector>
+#include "MPMCQueue.h"
+#include "ThreadAffinity.h"
 
 namespace SoftGL {
 
+// idle workers spin (yield) this many times before parking on condition variable,
+// keep latency low between back-to-back task batches (e.g. draw calls of one frame)
+#define THREAD_POOL_SPIN_COUNT 64
+
+// callable up to this size is stored inside task, larger one falls back to heap
+#define THREAD_POOL_TASK_STORAGE 112
+
+// per-worker ring capacity of each priority, task is executed on pushing thread if all rings are full
+#define THREAD_POOL_QUEUE_SIZE 1024
+
+// every N pops a worker serves priorities from low to high, so low priority tasks are not starved
+#define THREAD_POOL_FAIR_INTERVAL 16
+
+// tasks of higher priority are popped first, same priority in FIFO order per worker ring.
+// no fairness between submitters (e.g. renderers) of the same priority: one flooding the pool delays the others
+enum TaskPriority {
+  TaskPriority_HIGH,     // latency critical, e.g. frame graph cpu passes
+  TaskPriority_NORMAL,   // rasterization
+  TaskPriority_LOW,      // background, e.g. model & texture loading
+  TaskPriority_COUNT,
+};
+
+// move-only task with fixed size inline storage, called through function pointer instead of std::function,
+// no allocation for small captures. trivially copyable callable is moved by memcpy
+class InlineTask {
+ public:
+  InlineTask() = default;
+
+  template<typename F>
+  explicit InlineTask(const F &func) {
+    init(func, std::integral_constant<bool, fitsInline<F>()>());
+  }
+
+  InlineTask(InlineTask &&other) noexcept {
+    moveFrom(other);
+  }
+
+  InlineTask &operator=(InlineTask &&other) noexcept {
+    if (this != &other) {
+      reset();
+      moveFrom(other);
+    }
+    return *this;
+  }
+
+  InlineTask(const InlineTask &) = delete;
+  InlineTask &operator=(const InlineTask &) = delete;
+
+  ~InlineTask() {
+    reset();
+  }
+
+  inline void operator()(size_t threadId) {
+    invoke_(&storage_, threadId);
+  }
+
+  inline explicit operator bool() const {
+    return invoke_ != nullptr;
+  }
+
+  void reset() {
+    if (manage_) {
+      manage_(&storage_, nullptr);
+    }
+    invoke_ = nullptr;
+    manage_ = nullptr;
+  }
+
+ private:
+  typedef void (*InvokeFunc)(void *storage, size_t threadId);
+  // src not null: move src to dst then destroy src, otherwise destroy dst
+  typedef void (*ManageFunc)(void *dst, void *src);
+  typedef typename std::aligned_storage<THREAD_POOL_TASK_STORAGE, alignof(std::max_align_t)>::type Storage;
+
+  template<typename F>
+  static constexpr bool fitsInline() {
+    return sizeof(F) <= sizeof(Storage) && alignof(F) <= alignof(Storage)
+        && std::is_nothrow_move_constructible<F>::value;
+  }
+
+  template<typename F>
+  struct InlineOps {
+    static void invoke(void *storage, size_t threadId) {
+      (*reinterpret_cast<F *>(storage))(threadId);
+    }
+    static void manage(void *dst, void *src) {
+      if (src) {
+        new(dst) F(std::move(*reinterpret_cast<F *>(src)));
+        reinterpret_cast<F *>(src)->~F();
+      } else {
+        reinterpret_cast<F *>(dst)->~F();
+      }
+    }
+  };
+
+  template<typename F>
+  struct HeapOps {
+    static void invoke(void *storage, size_t threadId) {
+      (**reinterpret_cast<F **>(storage))(threadId);
+    }
+    static void manage(void *dst, void *src) {
+      if (src) {
+        *reinterpret_cast<F **>(dst) = *reinterpret_cast<F **>(src);
+      } else {
+        delete *reinterpret_cast<F **>(dst);
+      }
+    }
+  };
+
+  template<typename F>
+  void init(const F &func, std::true_type) {
+    new(&storage_) F(func);
+    invoke_ = &InlineOps<F>::invoke;
+    manage_ = std::is_trivially_copyable<F>::value ? nullptr : &InlineOps<F>::manage;
+  }
+
+  template<typename F>
+  void init(const F &func, std::false_type) {
+    *reinterpret_cast<F **>(&storage_) = new F(func);
+    invoke_ = &HeapOps<F>::invoke;
+    manage_ = &HeapOps<F>::manage;
+  }
+
+  void moveFrom(InlineTask &other) {
+    invoke_ = other.invoke_;
+    manage_ = other.manage_;
+    if (manage_) {
+      manage_(&storage_, &other.storage_);
+    } else if (invoke_) {
+      memcpy(&storage_, &other.storage_, sizeof(Storage));
+    }
+    other.invoke_ = nullptr;
+    other.manage_ = nullptr;
+  }
+
+ private:
+  Storage storage_;
+  InvokeFunc invoke_ = nullptr;
+  ManageFunc manage_ = nullptr;
+};
+
+// worker count & placement
+struct ThreadPoolConfig {
+  size_t threadCnt = 0;     // 0: one worker per allowed cpu
+  bool pinThreads = false;  // pin worker i to i-th allowed cpu, otherwise workers float on allowed cpus
+  int numaNode = -1;        // >= 0: only cpus of this node are allowed
+
+  // fields overridden by env SOFTGL_THREADS, SOFTGL_THREAD_PIN (0/1), SOFTGL_NUMA_NODE if set
+  ThreadPoolConfig &loadEnv() {
+    if (const char *env = getenv("SOFTGL_THREADS")) {
+      threadCnt = (size_t) std::max(atoi(env), 0);
+    }
+    if (const char *env = getenv("SOFTGL_THREAD_PIN")) {
+      pinThreads = atoi(env) != 0;
+    }
+    if (const char *env = getenv("SOFTGL_NUMA_NODE")) {
+      numaNode = atoi(env);
+    }
+    return *this;
+  }
+
+  static ThreadPoolConfig fromEnv() {
+    return ThreadPoolConfig().loadEnv();
+  }
+
+  // resolve auto thread count
+  size_t getThreadCnt() const {
+    if (threadCnt > 0) {
+      return threadCnt;
+    }
+    size_t cpuCnt = ThreadAffinity::getCpuList(numaNode).size();
+    return cpuCnt > 0 ? cpuCnt : std::max((size_t) std::thread::hardware_concurrency(), (size_t) 1);
+  }
+};
+
+// tasks pushed with the same group can be waited without waiting the whole pool
+class TaskGroup {
+ public:
+  explicit TaskGroup(TaskPriority priority = TaskPriority_NORMAL) : priority_(priority) {}
+
+  inline bool finished() const {
+    return pending_ == 0;
+  }
+
+  inline TaskPriority getPriority() const {
+    return priority_;
+  }
+
+  // only while no task of group is pending
+  inline void setPriority(TaskPriority priority) {
+    priority_ = priority;
+  }
+
+ private:
+  friend class ThreadPool;
+  std::atomic<size_t> pending_{0};
+  TaskPriority priority_ = TaskPriority_NORMAL;
+};
+
 class ThreadPool {
  public:
 
-  explicit ThreadPool(const size_t threadCnt = std::thread::hardware_concurrency())
-      : threadCnt_(threadCnt),
-        threads_(new std::thread[threadCnt]) {
+  explicit ThreadPool(const ThreadPoolConfig &config = ThreadPoolConfig::fromEnv())
+      : ThreadPool(config.getThreadCnt(), config) {}
+
+  // exact thread count (may be 0), placement of config
+  ThreadPool(const size_t threadCnt, const ThreadPoolConfig &config)
+      : config_(config),
+        threadCnt_(threadCnt),
+        threads_(new std::thread[threadCnt]),
+        queueCnt_(std::max(threadCnt, (size_t) 1)),
+        queues_(new WorkQueue[queueCnt_]) {
+    if (config_.pinThreads || config_.numaNode >= 0) {
+      cpus_ = ThreadAffinity::getCpuList(config_.numaNode);
+    }
     createThreads();
   }
 
+  explicit ThreadPool(const size_t threadCnt) : ThreadPool(threadCnt, ThreadPoolConfig()) {}
+
   ~ThreadPool() {
     waitTasksFinish();
-    running_ = false;
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      running_ = false;
+    }
+    taskCond_.notify_all();
     joinThreads();
   }
 
+  // process-wide pool shared by all software renderers, frame graphs and loaders, created on first use.
+  // submitters wait their own TaskGroup instead of waitTasksFinish
+  static ThreadPool &shared() {
+    static ThreadPool pool(createSharedConfig());
+    return pool;
+  }
+
+  // config of shared pool, return false if it's already created
+  static bool configureShared(const ThreadPoolConfig &config) {
+    auto &state = sharedState();
+    const std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.created) {
+      return false;
+    }
+    state.config = config;
+    return true;
+  }
+
   inline size_t getThreadCnt() const {
     return threadCnt_;
   }
 
   template<typename F>
-  void pushTask(const F &task) {
+  void pushTask(const F &func) {
+    pushTask(TaskPriority_NORMAL, func);
+  }
+
+  // called from worker thread: push to its own queue, otherwise distribute round-robin.
+  // if target ring is full try the others, all full: run on calling thread (also when paused)
+  template<typename F>
+  void pushTask(TaskPriority priority, const F &func) {
     tasksCnt_++;
-    {
-      const std::lock_guard<std::mutex> lock(mutex_);
-      tasks_.push(std::function<void(size_t)>(task));
+    tasksQueuedCnt_++;
+    Task task(func);
+    size_t idx = (currentPool() == this) ? currentWorker() : (pushIndex_++ % queueCnt_);
+    for (size_t i = 0; i < queueCnt_; i++) {
+      if (queues_[(idx + i) % queueCnt_].tasks[priority].tryPush(task)) {
+        // wake one parked worker and parked helping waiters, lock to avoid lost wakeup
+        if (sleepingCnt_ > 0 || helpingCnt_ > 0) {
+          { const std::lock_guard<std::mutex> lock(mutex_); }
+          if (sleepingCnt_ > 0) {
+            taskCond_.notify_one();
+          }
+          if (helpingCnt_ > 0) {
+            finishCond_.notify_all();
+          }
+        }
+        return;
+      }
     }
+
+    tasksQueuedCnt_--;
+    task(callerThreadId());
+    finishTask();
   }
 
   template<typename F, typename... A>
   void pushTask(const F &task, const A &...args) {
-    pushTask([task, args...] { task(args...); });
+    pushTask([task, args...](size_t) { task(args...); });
   }
 
-  void waitTasksFinish() const {
-    while (true) {
-      if (!paused) {
-        if (tasksCnt_ == 0)
-          break;
-      } else {
-        if (tasksRunningCnt() == 0)
-          break;
+  template<typename F>
+  void pushTask(TaskGroup &group, const F &task) {
+    group.pending_++;
+    pushTask(group.priority_, [this, &group, task](size_t threadId) {
+      task(threadId);
+      finishGroupTask(group);
+    });
+  }
+
+  // wait tasks of group only, worker thread helps executing queued tasks meanwhile, so it's safe to wait
+  // inside a task. non-worker threads share thread id getThreadCnt(), they only block (help if pool has no
+  // worker), otherwise two submitters could run tasks of one client with the same thread id.
+  // helping = false: worker only blocks too
+  void waitGroup(TaskGroup &group, bool helping = true) {
+    size_t threadId = callerThreadId();
+    helping = (helping && threadId < threadCnt_) || threadCnt_ == 0;
+    Task task;
+    int spinCnt = 0;
+    while (!group.finished()) {
+      if (helping && popTask(threadId, task)) {
+        task(threadId);
+        task.reset();
+        finishTask();
+        spinCnt = 0;
+        continue;
+      }
+      // nothing to help, remaining tasks are running on other threads, spin before parking
+      if (spinCnt++ < THREAD_POOL_SPIN_COUNT) {
+        std::this_thread::yield();
+        continue;
+      }
+      // woken by group finish, or by pushTask if helping
+      std::unique_lock<std::mutex> lock(mutex_);
+      int helpingInc = helping ? 1 : 0;
+      helpingCnt_ += helpingInc;
+      finishCond_.wait(lock, [&] {
+        return group.finished() || (helping && taskAvailable());
+      });
+      helpingCnt_ -= helpingInc;
+    }
+  }
+
+  // func(begin, end, threadId) over [begin, end), threadId in [0, getThreadCnt()].
+  // range is split in half while other workers are hungry, otherwise processed in grain sized
+  // chunks locally. grain 0: about 4 chunks per thread
+  template<typename F>
+  void parallelFor(size_t begin, size_t end, size_t grain, const F &func,
+                   TaskPriority priority = TaskPriority_NORMAL) {
+    if (begin >= end) {
+      return;
+    }
+    if (grain == 0) {
+      grain = std::max((size_t) 1, (end - begin) / (queueCnt_ * 4));
+    }
+    TaskGroup group(priority);
+    parallelForImpl(group, begin, end, grain, func, callerThreadId());
+    waitGroup(group);
+  }
+
+  void waitTasksFinish() {
+    // short spin, most batches finish soon after submit
+    for (int i = 0; i < THREAD_POOL_SPIN_COUNT; i++) {
+      if (tasksFinished()) {
+        return;
       }
       std::this_thread::yield();
     }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    finishCond_.wait(lock, [&] { return tasksFinished(); });
   }
 
-  std::atomic<bool> paused{false};
+  // paused: queued tasks are kept, waitTasksFinish only waits running tasks
+  void setPaused(bool paused) {
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      paused_ = paused;
+    }
+    taskCond_.notify_all();
+    finishCond_.notify_all();
+  }
+
+  inline bool isPaused() const {
+    return paused_;
+  }
 
  private:
+  typedef InlineTask Task;
+
+  // per-worker lock-free ring of each priority, owner and thieves all pop in FIFO order
+  struct WorkQueue {
+    MPMCQueue<Task, THREAD_POOL_QUEUE_SIZE> tasks[TaskPriority_COUNT];
+  };
+
+  struct SharedState {
+    std::mutex mutex;
+    ThreadPoolConfig config = ThreadPoolConfig::fromEnv();
+    bool created = false;
+  };
+
+  static SharedState &sharedState() {
+    static SharedState state;
+    return state;
+  }
+
+  static ThreadPoolConfig createSharedConfig() {
+    auto &state = sharedState();
+    const std::lock_guard<std::mutex> lock(state.mutex);
+    state.created = true;
+    return state.config;
+  }
+
+  bool popFromQueue(WorkQueue &queue, int priority, Task &task) {
+    auto &ring = queue.tasks[priority];
+    if (ring.empty() || !ring.tryPop(task)) {
+      return false;
+    }
+    tasksQueuedCnt_--;
+    return true;
+  }
+
+  static ThreadPool *&currentPool() {
+    static thread_local ThreadPool *pool = nullptr;
+    return pool;
+  }
+
+  static size_t &currentWorker() {
+    static thread_local size_t worker = 0;
+    return worker;
+  }
+
+  inline size_t callerThreadId() const {
+    return (currentPool() == this) ? currentWorker() : (size_t) threadCnt_;
+  }
+
+  template<typename F>
+  void parallelForImpl(TaskGroup &group, size_t begin, size_t end, size_t grain, const F &func, size_t threadId) {
+    while (end - begin > grain) {
+      if (tasksQueuedCnt_ < queueCnt_) {
+        size_t mid = begin + (end - begin) / 2;
+        pushTask(group, [this, &group, mid, end, grain, &func](size_t tid) {
+          parallelForImpl(group, mid, end, grain, func, tid);
+        });
+        end = mid;
+      } else {
+        func(begin, begin + grain, threadId);
+        begin += grain;
+      }
+    }
+    func(begin, end, threadId);
+  }
+
   void createThreads() {
     for (size_t i = 0; i < threadCnt_; i++) {
       threads_[i] = std::thread(&ThreadPool::taskWorker, this, i);
@@ -77,47 +477,131 @@ class ThreadPool {
     }
   }
 
-  size_t tasksQueuedCnt() const {
-    const std::lock_guard<std::mutex> lock(mutex_);
-    return tasks_.size();
+  inline bool tasksFinished() const {
+    return paused_ ? (tasksCnt_ == tasksQueuedCnt_) : (tasksCnt_ == 0);
   }
 
-  size_t tasksRunningCnt() const {
-    return tasksCnt_ - tasksQueuedCnt();
+  inline bool taskAvailable() const {
+    return !paused_ && tasksQueuedCnt_ > 0;
   }
 
-  bool popTask(std::function<void(size_t)> &task) {
-    const std::lock_guard<std::mutex> lock(mutex_);
-    if (tasks_.empty())
+  bool popTask(size_t threadId, Task &task) {
+    if (!taskAvailable()) {
       return false;
-    else {
-      task = std::move(tasks_.front());
-      tasks_.pop();
+    }
+
+    static thread_local size_t popCnt = 0;
+    bool lowFirst = (++popCnt % THREAD_POOL_FAIR_INTERVAL) == 0;
+    for (int i = 0; i < TaskPriority_COUNT; i++) {
+      int priority = lowFirst ? (TaskPriority_COUNT - 1 - i) : i;
+      if (popTaskPriority(threadId, priority, task)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool popTaskPriority(size_t threadId, int priority, Task &task) {
+    // local queue first, non-worker thread has no local queue
+    bool isWorker = threadId < threadCnt_;
+    if (isWorker && popFromQueue(queues_[threadId], priority, task)) {
       return true;
     }
+
+    // steal from others
+    for (size_t i = isWorker ? 1 : 0; i < queueCnt_; i++) {
+      if (popFromQueue(queues_[(threadId + i) % queueCnt_], priority, task)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void finishGroupTask(TaskGroup &group) {
+    if (--group.pending_ == 0) {
+      { const std::lock_guard<std::mutex> lock(mutex_); }
+      finishCond_.notify_all();
+    }
+  }
+
+  void finishTask() {
+    size_t left = --tasksCnt_;
+    if (left == 0 || paused_) {
+      // lock to avoid lost wakeup of waitTasksFinish
+      { const std::lock_guard<std::mutex> lock(mutex_); }
+      finishCond_.notify_all();
+    }
+  }
+
+  // set before worker touches any memory, so its allocations are first touched on its own numa node
+  void setupAffinity(size_t threadId) {
+    if (cpus_.empty()) {
+      return;
+    }
+    if (config_.pinThreads) {
+      ThreadAffinity::setCurrentThreadCpus({cpus_[threadId % cpus_.size()]});
+    } else {
+      ThreadAffinity::setCurrentThreadCpus(cpus_);
+    }
   }
 
   void taskWorker(size_t threadId) {
-    while (running_) {
-      std::function<void(size_t)> task;
-      if (!paused && popTask(task)) {
-        task(threadId);
-        tasksCnt_--;
-      } else {
+    setupAffinity(threadId);
+    currentPool() = this;
+    currentWorker() = threadId;
+
+    Task task;
+    while (true) {
+      // spin before parking
+      bool got = false;
+      for (int i = 0; i < THREAD_POOL_SPIN_COUNT && running_; i++) {
+        if (popTask(threadId, task)) {
+          got = true;
+          break;
+        }
         std::this_thread::yield();
       }
+
+      if (!got) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        sleepingCnt_++;
+        taskCond_.wait(lock, [&] { return !running_ || taskAvailable(); });
+        sleepingCnt_--;
+        if (!running_) {
+          break;
+        }
+        continue;
+      }
+
+      task(threadId);
+      task.reset();
+      finishTask();
     }
+
+    currentPool() = nullptr;
   }
 
  private:
-  mutable std::mutex mutex_ = {};
+  std::mutex mutex_ = {};   // only for parking & finish waiting
+  std::condition_variable taskCond_;
+  std::condition_variable finishCond_;
   std::atomic<bool> running_{true};
+  std::atomic<bool> paused_{false};
+
+  ThreadPoolConfig config_;
+  std::vector<int> cpus_;   // allowed cpus, empty: no affinity
 
-  std::unique_ptr<std::thread[]> threads_;
   std::atomic<size_t> threadCnt_{0};
+  std::unique_ptr<std::thread[]> threads_;
+
+  size_t queueCnt_ = 1;
+  std::unique_ptr<WorkQueue[]> queues_;
+  std::atomic<size_t> pushIndex_{0};
 
-  std::queue<std::function<void(size_t)>> tasks_ = {};
   std::atomic<size_t> tasksCnt_{0};
+  std::atomic<size_t> tasksQueuedCnt_{0};
+  std::atomic<int> sleepingCnt_{0};
+  std::atomic<int> helpingCnt_{0};   // waitGroup callers parked while able to help
 };
 
 }
@@ -21,4 +21,9 @@ int64_t Timer::elapseMillis() const {
   return duration.count();
 }
 
+float Timer::elapseMillisFloat() const {
+  auto duration = std::chrono::duration_cast<std::chrono::duration<float, std::milli>>(end_ - start_);
+  return duration.count();
+}
+
 }
@@ -18,6 +18,7 @@ class Timer {
   void start();
   void stop();
   int64_t elapseMillis() const;
+  float elapseMillisFloat() const;
 
  private:
   std::chrono::time_point<std::chrono::steady_clock> start_;
@@ -7,10 +7,14 @@
 #pragma once
 
 #include <memory>
+#include <algorithm>
+#include "Base/Logger.h"
 #include "Texture.h"
 
 namespace SoftGL {
 
+#define MAX_COLOR_ATTACHMENTS 8
+
 struct FrameBufferAttachment {
   std::shared_ptr<Texture> tex = nullptr;
   uint32_t layer = 0; // for cube map
@@ -25,19 +29,37 @@ class FrameBuffer {
   virtual bool isValid() = 0;
 
   virtual void setColorAttachment(std::shared_ptr<Texture> &color, int level) {
-    colorAttachment_.tex = color;
-    colorAttachment_.layer = 0;
-    colorAttachment_.level = level;
+    colorAttachments_[0].tex = color;
+    colorAttachments_[0].layer = 0;
+    colorAttachments_[0].level = level;
+    colorAttachmentCnt_ = std::max(colorAttachmentCnt_, 1);
     colorReady_ = true;
   };
 
   virtual void setColorAttachment(std::shared_ptr<Texture> &color, CubeMapFace face, int level) {
-    colorAttachment_.tex = color;
-    colorAttachment_.layer = face;
-    colorAttachment_.level = level;
+    colorAttachments_[0].tex = color;
+    colorAttachments_[0].layer = face;
+    colorAttachments_[0].level = level;
+    colorAttachmentCnt_ = std::max(colorAttachmentCnt_, 1);
     colorReady_ = true;
   };
 
+  // multiple render targets, index 0 is the same as setColorAttachment(color, level)
+  virtual void setColorAttachment(int index, std::shared_ptr<Texture> &color, int level) {
+    if (index < 0 || index >= MAX_COLOR_ATTACHMENTS) {
+      LOGE("setColorAttachment failed: index out of range: %d", index);
+      return;
+    }
+    if (index == 0) {
+      setColorAttachment(color, level);
+      return;
+    }
+    colorAttachments_[index].tex = color;
+    colorAttachments_[index].layer = 0;
+    colorAttachments_[index].level = level;
+    colorAttachmentCnt_ = std::max(colorAttachmentCnt_, index + 1);
+  };
+
   virtual void setDepthAttachment(std::shared_ptr<Texture> &depth) {
     depthAttachment_.tex = depth;
     depthAttachment_.layer = 0;
@@ -45,8 +67,19 @@ class FrameBuffer {
     depthReady_ = true;
   };
 
-  inline const FrameBufferAttachment &getColorAttachment() const {
-    return colorAttachment_;
+  // empty attachment if index out of range
+  inline const FrameBufferAttachment &getColorAttachment(int index = 0) const {
+    if (index < 0 || index >= MAX_COLOR_ATTACHMENTS) {
+      LOGE("getColorAttachment failed: index out of range: %d", index);
+      static const FrameBufferAttachment empty{};
+      return empty;
+    }
+    return colorAttachments_[index];
+  }
+
+  // highest used color attachment index + 1
+  inline int getColorAttachmentCount() const {
+    return colorAttachmentCnt_;
   }
 
   inline const FrameBufferAttachment &getDepthAttachment() const {
@@ -85,8 +118,8 @@ class FrameBuffer {
   bool colorReady_ = false;
   bool depthReady_ = false;
 
-  // TODO MTR
-  FrameBufferAttachment colorAttachment_{};
+  FrameBufferAttachment colorAttachments_[MAX_COLOR_ATTACHMENTS];
+  int colorAttachmentCnt_ = 0;
   FrameBufferAttachment depthAttachment_{};
 };
 
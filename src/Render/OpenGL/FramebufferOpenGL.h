@@ -43,7 +43,7 @@ class FrameBufferOpenGL : public FrameBuffer {
   }
 
   void setColorAttachment(std::shared_ptr<Texture> &color, int level) override {
-    if (color == colorAttachment_.tex && level == colorAttachment_.level) {
+    if (color == colorAttachments_[0].tex && level == colorAttachments_[0].level) {
       return;
     }
 
@@ -57,7 +57,7 @@ class FrameBufferOpenGL : public FrameBuffer {
   }
 
   void setColorAttachment(std::shared_ptr<Texture> &color, CubeMapFace face, int level) override {
-    if (color == colorAttachment_.tex && face == colorAttachment_.layer && level == colorAttachment_.level) {
+    if (color == colorAttachments_[0].tex && face == colorAttachments_[0].layer && level == colorAttachments_[0].level) {
       return;
     }
 
@@ -70,6 +70,31 @@ class FrameBufferOpenGL : public FrameBuffer {
                                     level));
   }
 
+  void setColorAttachment(int index, std::shared_ptr<Texture> &color, int level) override {
+    if (index == 0 || index >= MAX_COLOR_ATTACHMENTS) {
+      FrameBuffer::setColorAttachment(index, color, level);
+      return;
+    }
+    if (color == colorAttachments_[index].tex && level == colorAttachments_[index].level) {
+      return;
+    }
+
+    FrameBuffer::setColorAttachment(index, color, level);
+    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, fbo_));
+    GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER,
+                                    GL_COLOR_ATTACHMENT0 + index,
+                                    color->multiSample ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D,
+                                    color->getId(),
+                                    level));
+
+    // enable all draw buffers
+    GLenum drawBuffers[MAX_COLOR_ATTACHMENTS];
+    for (int i = 0; i < colorAttachmentCnt_; i++) {
+      drawBuffers[i] = colorAttachments_[i].tex ? GL_COLOR_ATTACHMENT0 + i : GL_NONE;
+    }
+    GL_CHECK(glDrawBuffers(colorAttachmentCnt_, drawBuffers));
+  }
+
   void setDepthAttachment(std::shared_ptr<Texture> &depth) override {
     if (depth == depthAttachment_.tex) {
       return;
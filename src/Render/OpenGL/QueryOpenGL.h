@@ -0,0 +1,63 @@
+/*
+ * SoftGLRender
+ * @author 	: keith@robot9.me
+ *
+ */
+
+#pragma once
+
+#include <glad/glad.h>
+#include "Render/Query.h"
+#include "Render/OpenGL/OpenGLUtils.h"
+
+namespace SoftGL {
+
+class QueryObjectOpenGL : public QueryObject {
+ public:
+  QueryObjectOpenGL() {
+    GL_CHECK(glGenQueries(1, &id_));
+  }
+
+  ~QueryObjectOpenGL() {
+    GL_CHECK(glDeleteQueries(1, &id_));
+  }
+
+  int getId() const override {
+    return (int) id_;
+  }
+
+  inline void begin() {
+    GL_CHECK(glBeginQuery(GL_SAMPLES_PASSED, id_));
+    issued_ = true;
+  }
+
+  inline void end() {
+    GL_CHECK(glEndQuery(GL_SAMPLES_PASSED));
+  }
+
+  // non-blocking, return false if result not ready
+  bool getResult(uint64_t &samples) {
+    if (!issued_) {
+      return false;
+    }
+    GLuint available = GL_FALSE;
+    GL_CHECK(glGetQueryObjectuiv(id_, GL_QUERY_RESULT_AVAILABLE, &available));
+    if (available == GL_FALSE) {
+      return false;
+    }
+    GLuint64 result = 0;
+    GL_CHECK(glGetQueryObjectui64v(id_, GL_QUERY_RESULT, &result));
+    samples = result;
+    return true;
+  }
+
+  inline bool issued() const {
+    return issued_;
+  }
+
+ private:
+  GLuint id_ = 0;
+  bool issued_ = false;
+};
+
+}
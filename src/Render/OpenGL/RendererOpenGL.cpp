@@ -55,10 +55,20 @@ std::shared_ptr<UniformSampler> RendererOpenGL::createUniformSampler(const std::
 }
 
 // pipeline
-void RendererOpenGL::beginRenderPass(std::shared_ptr<FrameBuffer> &frameBuffer, const ClearStates &states) {
+void RendererOpenGL::beginRenderPass(std::shared_ptr<FrameBuffer> &frameBuffer, const ClearStates &states,
+                                     const Rect2D &renderArea) {
   auto *fbo = dynamic_cast<FrameBufferOpenGL *>(frameBuffer.get());
   fbo->bind();
 
+  // render area, glClear is also restricted by scissor
+  renderArea_ = renderArea;
+  if (renderArea_.empty()) {
+    GL_CHECK(glDisable(GL_SCISSOR_TEST));
+  } else {
+    GL_CHECK(glEnable(GL_SCISSOR_TEST));
+    GL_CHECK(glScissor(renderArea_.x, renderArea_.y, renderArea_.width, renderArea_.height));
+  }
+
   GLbitfield clearBit = 0;
   if (states.colorFlag) {
     GL_CHECK(glClearColor(states.clearColor.r, states.clearColor.g, states.clearColor.b, states.clearColor.a));
@@ -114,6 +124,7 @@ void RendererOpenGL::setPipelineStates(std::shared_ptr<PipelineStates> &states)
                                OpenGL::cvtBlendFactor(renderStates.blendParams.blendDstRgb),
                                OpenGL::cvtBlendFactor(renderStates.blendParams.blendSrcAlpha),
                                OpenGL::cvtBlendFactor(renderStates.blendParams.blendDstAlpha)));
+  GL_CHECK(glColorMask(renderStates.colorMask, renderStates.colorMask, renderStates.colorMask, renderStates.colorMask));
 
   // depth
   GL_STATE_SET(renderStates.depthTest, GL_DEPTH_TEST)
@@ -125,6 +136,18 @@ void RendererOpenGL::setPipelineStates(std::shared_ptr<PipelineStates> &states)
 
   GL_CHECK(glLineWidth(renderStates.lineWidth));
   GL_CHECK(glEnable(GL_PROGRAM_POINT_SIZE));
+
+  // scissor
+  if (renderStates.scissorTest || !renderArea_.empty()) {
+    Rect2D scissor = renderArea_;
+    if (renderStates.scissorTest) {
+      scissor = renderArea_.empty() ? renderStates.scissor : renderArea_.intersect(renderStates.scissor);
+    }
+    GL_CHECK(glEnable(GL_SCISSOR_TEST));
+    GL_CHECK(glScissor(scissor.x, scissor.y, scissor.width, scissor.height));
+  } else {
+    GL_CHECK(glDisable(GL_SCISSOR_TEST));
+  }
 }
 
 void RendererOpenGL::draw() {
@@ -135,9 +158,11 @@ void RendererOpenGL::draw() {
 void RendererOpenGL::endRenderPass() {
   // reset gl states
   GL_CHECK(glDisable(GL_BLEND));
+  GL_CHECK(glColorMask(true, true, true, true));
   GL_CHECK(glDisable(GL_DEPTH_TEST));
   GL_CHECK(glDepthMask(true));
   GL_CHECK(glDisable(GL_CULL_FACE));
+  GL_CHECK(glDisable(GL_SCISSOR_TEST));
   GL_CHECK(glPolygonMode(GL_FRONT_AND_BACK, GL_FILL));
 }
 
@@ -145,4 +170,43 @@ void RendererOpenGL::waitIdle() {
   GL_CHECK(glFinish());
 }
 
+std::shared_ptr<QueryObject> RendererOpenGL::createQuery() {
+  return std::make_shared<QueryObjectOpenGL>();
+}
+
+void RendererOpenGL::beginQuery(std::shared_ptr<QueryObject> &query) {
+  auto *queryGL = dynamic_cast<QueryObjectOpenGL *>(query.get());
+  if (queryGL) {
+    queryGL->begin();
+  }
+}
+
+void RendererOpenGL::endQuery(std::shared_ptr<QueryObject> &query) {
+  auto *queryGL = dynamic_cast<QueryObjectOpenGL *>(query.get());
+  if (queryGL) {
+    queryGL->end();
+  }
+}
+
+bool RendererOpenGL::getQueryResult(std::shared_ptr<QueryObject> &query, uint64_t &samples) {
+  auto *queryGL = dynamic_cast<QueryObjectOpenGL *>(query.get());
+  return queryGL && queryGL->getResult(samples);
+}
+
+void RendererOpenGL::beginConditionalRender(std::shared_ptr<QueryObject> &query) {
+  auto *queryGL = dynamic_cast<QueryObjectOpenGL *>(query.get());
+  if (queryGL && queryGL->issued()) {
+    // draw anyway if result not ready, avoid gpu stall
+    GL_CHECK(glBeginConditionalRender(queryGL->getId(), GL_QUERY_NO_WAIT));
+    conditionalRender_ = true;
+  }
+}
+
+void RendererOpenGL::endConditionalRender() {
+  if (conditionalRender_) {
+    GL_CHECK(glEndConditionalRender());
+    conditionalRender_ = false;
+  }
+}
+
 }
@@ -9,6 +9,7 @@
 #include "Render/Renderer.h"
 #include "Render/OpenGL/VertexOpenGL.h"
 #include "Render/OpenGL/ShaderProgramOpenGL.h"
+#include "Render/OpenGL/QueryOpenGL.h"
 
 namespace SoftGL {
 
@@ -36,7 +37,8 @@ class RendererOpenGL : public Renderer {
   std::shared_ptr<UniformSampler> createUniformSampler(const std::string &name, const TextureDesc &desc) override;
 
   // pipeline
-  void beginRenderPass(std::shared_ptr<FrameBuffer> &frameBuffer, const ClearStates &states) override;
+  void beginRenderPass(std::shared_ptr<FrameBuffer> &frameBuffer, const ClearStates &states,
+                       const Rect2D &renderArea = {}) override;
   void setViewPort(int x, int y, int width, int height) override;
   void setVertexArrayObject(std::shared_ptr<VertexArrayObject> &vao) override;
   void setShaderProgram(std::shared_ptr<ShaderProgram> &program) override;
@@ -46,10 +48,20 @@ class RendererOpenGL : public Renderer {
   void endRenderPass() override;
   void waitIdle() override;
 
+  // occlusion query
+  std::shared_ptr<QueryObject> createQuery() override;
+  void beginQuery(std::shared_ptr<QueryObject> &query) override;
+  void endQuery(std::shared_ptr<QueryObject> &query) override;
+  bool getQueryResult(std::shared_ptr<QueryObject> &query, uint64_t &samples) override;
+  void beginConditionalRender(std::shared_ptr<QueryObject> &query) override;
+  void endConditionalRender() override;
+
  private:
+  Rect2D renderArea_{};
   VertexArrayObjectOpenGL *vao_ = nullptr;
   ShaderProgramOpenGL *shaderProgram_ = nullptr;
   PipelineStates *pipelineStates_ = nullptr;
+  bool conditionalRender_ = false;
 };
 
 }
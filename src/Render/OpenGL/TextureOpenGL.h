@@ -38,12 +38,25 @@ class TextureOpenGL : public Texture {
         ret.type = GL_FLOAT;
         break;
       }
+      case TextureFormat_RGBA16F: {
+        ret.internalformat = GL_RGBA16F;
+        ret.format = GL_RGBA;
+        ret.type = GL_HALF_FLOAT;
+        break;
+      }
+      case TextureFormat_RGBA32F: {
+        ret.internalformat = GL_RGBA32F;
+        ret.format = GL_RGBA;
+        ret.type = GL_FLOAT;
+        break;
+      }
     }
 
     return ret;
   }
 
-  void dumpImage(const char *path, uint32_t layer, uint32_t level) override {
+  void dumpImage(const char *path, uint32_t layer, uint32_t level,
+                 ImageDumpMode mode = ImageDump_DEFAULT) override {
     if (multiSample) {
       return;
     }
@@ -62,15 +75,21 @@ class TextureOpenGL : public Texture {
     auto levelWidth = (int32_t) getLevelWidth(level);
     auto levelHeight = (int32_t) getLevelHeight(level);
 
+    // hdr formats are read back as clamped RGBA8
+    GLenum readType = (format == TextureFormat_FLOAT32) ? glDesc_.type : GL_UNSIGNED_BYTE;
     auto *pixels = new uint8_t[levelWidth * levelHeight * 4];
-    GL_CHECK(glReadPixels(0, 0, levelWidth, levelHeight, glDesc_.format, glDesc_.type, pixels));
+    GL_CHECK(glReadPixels(0, 0, levelWidth, levelHeight, glDesc_.format, readType, pixels));
 
     GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
     GL_CHECK(glDeleteFramebuffers(1, &fbo));
 
     // convert float to rgba
     if (format == TextureFormat_FLOAT32) {
-      ImageUtils::convertFloatImage(reinterpret_cast<RGBA *>(pixels), reinterpret_cast<float *>(pixels), levelWidth, levelHeight);
+      if (mode == ImageDump_HEATMAP) {
+        ImageUtils::convertHeatmapImage(reinterpret_cast<RGBA *>(pixels), reinterpret_cast<float *>(pixels), levelWidth, levelHeight);
+      } else {
+        ImageUtils::convertFloatImage(reinterpret_cast<RGBA *>(pixels), reinterpret_cast<float *>(pixels), levelWidth, levelHeight);
+      }
     }
     ImageUtils::writeImage(path, levelWidth, levelHeight, 4, pixels, levelWidth * 4, true);
     delete[] pixels;
@@ -123,12 +142,25 @@ class Texture2DOpenGL : public TextureOpenGL {
   }
 
   void setImageData(const std::vector<std::shared_ptr<Buffer<RGBA>>> &buffers) override {
+    setImageDataImpl(buffers, TextureFormat_RGBA8);
+  }
+
+  void setImageData(const std::vector<std::shared_ptr<Buffer<RGBA16F>>> &buffers) override {
+    setImageDataImpl(buffers, TextureFormat_RGBA16F);
+  }
+
+  void setImageData(const std::vector<std::shared_ptr<Buffer<RGBA32F>>> &buffers) override {
+    setImageDataImpl(buffers, TextureFormat_RGBA32F);
+  }
+
+  template<typename T>
+  void setImageDataImpl(const std::vector<std::shared_ptr<Buffer<T>>> &buffers, TextureFormat bufferFormat) {
     if (multiSample) {
       LOGE("setImageData not support: multi sample texture");
       return;
     }
 
-    if (format != TextureFormat_RGBA8) {
+    if (format != bufferFormat) {
       LOGE("setImageData error: format not match");
       return;
     }
@@ -208,11 +240,24 @@ class TextureCubeOpenGL : public TextureOpenGL {
   }
 
   void setImageData(const std::vector<std::shared_ptr<Buffer<RGBA>>> &buffers) override {
+    setImageDataImpl(buffers, TextureFormat_RGBA8);
+  }
+
+  void setImageData(const std::vector<std::shared_ptr<Buffer<RGBA16F>>> &buffers) override {
+    setImageDataImpl(buffers, TextureFormat_RGBA16F);
+  }
+
+  void setImageData(const std::vector<std::shared_ptr<Buffer<RGBA32F>>> &buffers) override {
+    setImageDataImpl(buffers, TextureFormat_RGBA32F);
+  }
+
+  template<typename T>
+  void setImageDataImpl(const std::vector<std::shared_ptr<Buffer<T>>> &buffers, TextureFormat bufferFormat) {
     if (multiSample) {
       return;
     }
 
-    if (format != TextureFormat_RGBA8) {
+    if (format != bufferFormat) {
       LOGE("setImageData error: format not match");
       return;
     }
@@ -0,0 +1,47 @@
+/*
+ * SoftGLRender
+ * @author 	: keith@robot9.me
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace SoftGL {
+
+// ref: https://registry.khronos.org/vulkan/specs/1.3/html/chap17.html#queries-pipestats
+struct PipelineStatistics {
+  uint64_t drawCalls = 0;
+  uint64_t vertexShaderInvocations = 0;
+  uint64_t clippingInvocations = 0;       // primitives entering the clipper
+  uint64_t clippingPrimitives = 0;        // primitives leaving the clipper
+  uint64_t culledPrimitives = 0;          // primitives discarded by face culling
+  uint64_t primitivesEmitted = 0;         // primitives sent to rasterization
+  uint64_t quadsTested = 0;               // 2x2 quads with coverage
+  uint64_t quadsEarlyZKilled = 0;         // quads fully rejected by early-z
+  uint64_t fragmentShaderInvocations = 0;
+  uint64_t samplesWritten = 0;            // samples passed depth test and written
+  uint64_t helperPixels = 0;              // quad pixels interpolated only for derivatives
+
+  void reset() {
+    *this = PipelineStatistics();
+  }
+
+  PipelineStatistics &operator+=(const PipelineStatistics &o) {
+    drawCalls += o.drawCalls;
+    vertexShaderInvocations += o.vertexShaderInvocations;
+    clippingInvocations += o.clippingInvocations;
+    clippingPrimitives += o.clippingPrimitives;
+    culledPrimitives += o.culledPrimitives;
+    primitivesEmitted += o.primitivesEmitted;
+    quadsTested += o.quadsTested;
+    quadsEarlyZKilled += o.quadsEarlyZKilled;
+    fragmentShaderInvocations += o.fragmentShaderInvocations;
+    samplesWritten += o.samplesWritten;
+    helperPixels += o.helperPixels;
+    return *this;
+  }
+};
+
+}
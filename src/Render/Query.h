@@ -0,0 +1,19 @@
+/*
+ * SoftGLRender
+ * @author 	: keith@robot9.me
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace SoftGL {
+
+// occlusion query, result is the number of samples passed depth test
+class QueryObject {
+ public:
+  virtual int getId() const = 0;
+};
+
+}
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include "Base/GLMInc.h"
 
 namespace SoftGL {
@@ -48,6 +49,15 @@ enum PolygonMode {
   PolygonMode_FILL,
 };
 
+// coarse shading: one fragment shader invocation per WxH pixels
+// bit 0: 2 pixels high, bit 1: 2 pixels wide
+enum ShadingRate {
+  ShadingRate_1X1 = 0,
+  ShadingRate_1X2 = 1,
+  ShadingRate_2X1 = 2,
+  ShadingRate_2X2 = 3,
+};
+
 struct BlendParameters {
   BlendFunction blendFuncRgb = BlendFunc_ADD;
   BlendFactor blendSrcRgb = BlendFactor_ONE;
@@ -76,9 +86,50 @@ enum PrimitiveType {
   Primitive_TRIANGLE,
 };
 
+// framebuffer space rectangle, origin at lower-left (same as glScissor)
+struct Rect2D {
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+
+  inline bool empty() const {
+    return width <= 0 || height <= 0;
+  }
+
+  inline bool contains(int px, int py) const {
+    return px >= x && px < x + width && py >= y && py < y + height;
+  }
+
+  inline Rect2D merge(const Rect2D &o) const {
+    if (empty()) {
+      return o;
+    }
+    if (o.empty()) {
+      return *this;
+    }
+    Rect2D ret;
+    ret.x = std::min(x, o.x);
+    ret.y = std::min(y, o.y);
+    ret.width = std::max(x + width, o.x + o.width) - ret.x;
+    ret.height = std::max(y + height, o.y + o.height) - ret.y;
+    return ret;
+  }
+
+  inline Rect2D intersect(const Rect2D &o) const {
+    Rect2D ret;
+    ret.x = std::max(x, o.x);
+    ret.y = std::max(y, o.y);
+    ret.width = std::max(0, std::min(x + width, o.x + o.width) - ret.x);
+    ret.height = std::max(0, std::min(y + height, o.y + o.height) - ret.y);
+    return ret;
+  }
+};
+
 struct RenderStates {
   bool blend = false;
   BlendParameters blendParams;
+  bool colorMask = true;
 
   bool depthTest = false;
   bool depthMask = true;
@@ -89,6 +140,12 @@ struct RenderStates {
   PolygonMode polygonMode = PolygonMode_FILL;
 
   float lineWidth = 1.f;
+
+  bool scissorTest = false;
+  Rect2D scissor;
+
+  // only supported by software renderer
+  ShadingRate shadingRate = ShadingRate_1X1;
 };
 
 struct ClearStates {
@@ -11,6 +11,8 @@
 #include "ShaderProgram.h"
 #include "Texture.h"
 #include "PipelineStates.h"
+#include "PipelineStatistics.h"
+#include "Query.h"
 #include "Vertex.h"
 
 namespace SoftGL {
@@ -47,7 +49,9 @@ class Renderer {
   virtual std::shared_ptr<UniformSampler> createUniformSampler(const std::string &name, const TextureDesc &desc) = 0;
 
   // pipeline
-  virtual void beginRenderPass(std::shared_ptr<FrameBuffer> &frameBuffer, const ClearStates &states) = 0;
+  // renderArea: restrict clears, rasterization and resolve to this area, empty means whole framebuffer
+  virtual void beginRenderPass(std::shared_ptr<FrameBuffer> &frameBuffer, const ClearStates &states,
+                               const Rect2D &renderArea = {}) = 0;
   virtual void setViewPort(int x, int y, int width, int height) = 0;
   virtual void setVertexArrayObject(std::shared_ptr<VertexArrayObject> &vao) = 0;
   virtual void setShaderProgram(std::shared_ptr<ShaderProgram> &program) = 0;
@@ -56,6 +60,22 @@ class Renderer {
   virtual void draw() = 0;
   virtual void endRenderPass() = 0;
   virtual void waitIdle() = 0;
+
+  // statistics (nullptr if not supported)
+  virtual void resetFrameStatistics() {};
+  virtual const PipelineStatistics *getDrawStatistics() { return nullptr; };
+  virtual const PipelineStatistics *getFrameStatistics() { return nullptr; };
+
+  // occlusion query (nullptr if not supported)
+  virtual std::shared_ptr<QueryObject> createQuery() { return nullptr; };
+  virtual void beginQuery(std::shared_ptr<QueryObject> &query) {};
+  virtual void endQuery(std::shared_ptr<QueryObject> &query) {};
+  // return false if result not available yet
+  virtual bool getQueryResult(std::shared_ptr<QueryObject> &query, uint64_t &samples) { return false; };
+
+  // conditional rendering: draws skipped if query passed no samples
+  virtual void beginConditionalRender(std::shared_ptr<QueryObject> &query) {};
+  virtual void endConditionalRender() {};
 };
 
 }
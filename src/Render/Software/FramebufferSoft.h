@@ -24,12 +24,18 @@ class FrameBufferSoft : public FrameBuffer {
     return colorReady_ || depthReady_;
   }
 
-  std::shared_ptr<ImageBufferSoft<RGBA>> getColorBuffer() const {
-    if (!colorReady_) {
+  // T should match attachment format: RGBA, RGBA16F or RGBA32F
+  template<typename T = RGBA>
+  std::shared_ptr<ImageBufferSoft<T>> getColorBuffer(int index = 0) const {
+    if (!colorReady_ || index >= colorAttachmentCnt_ || !colorAttachments_[index].tex) {
       return nullptr;
     }
-    auto *colorTex = dynamic_cast<TextureSoft<RGBA> *>(colorAttachment_.tex.get());
-    return colorTex->getImage(colorAttachment_.layer).getBuffer(colorAttachment_.level);
+    auto &attachment = colorAttachments_[index];
+    auto *colorTex = dynamic_cast<TextureSoft<T> *>(attachment.tex.get());
+    if (!colorTex) {
+      return nullptr;
+    }
+    return colorTex->getImage(attachment.layer).getBuffer(attachment.level);
   };
 
   std::shared_ptr<ImageBufferSoft<float>> getDepthBuffer() const {
@@ -40,7 +46,23 @@ class FrameBufferSoft : public FrameBuffer {
     return depthTex->getImage(depthAttachment_.layer).getBuffer(depthAttachment_.level);
   };
 
+  // debug side buffer, per-pixel shading cost (FLOAT32, single sample)
+  void setShadingCostAttachment(std::shared_ptr<Texture> &cost) {
+    costAttachment_.tex = cost;
+    costAttachment_.layer = 0;
+    costAttachment_.level = 0;
+  }
+
+  std::shared_ptr<ImageBufferSoft<float>> getShadingCostBuffer() const {
+    if (!costAttachment_.tex) {
+      return nullptr;
+    }
+    auto *costTex = dynamic_cast<TextureSoft<float> *>(costAttachment_.tex.get());
+    return costTex->getImage().getBuffer();
+  };
+
  private:
+  FrameBufferAttachment costAttachment_{};
   UUID<FrameBufferSoft> uuid_;
 };
 
@@ -0,0 +1,197 @@
+/*
+ * SoftGLRender
+ * @author 	: keith@robot9.me
+ *
+ */
+
+#pragma once
+
+#include <type_traits>
+#include "Base/GLMInc.h"
+#include "Base/HalfFloat.h"
+#include "Base/ThreadPool.h"
+
+#ifdef SOFTGL_SIMD_OPT
+#include <emmintrin.h>
+#endif
+
+namespace SoftGL {
+
+// levels smaller than this are downsampled on calling thread
+#define MIPMAP_PARALLEL_MIN_PIXELS (64 * 64)
+// rows per task ~ this many dst pixels
+#define MIPMAP_TASK_PIXELS (128 * 128)
+
+// filtering type of texel
+template<typename T>
+struct MipTexelTraits {
+  using Acc = T;
+  static inline Acc load(const T &v) { return v; }
+  static inline T store(const Acc &v) { return v; }
+};
+
+template<>
+struct MipTexelTraits<RGBA> {
+  using Acc = glm::vec4;
+  static inline Acc load(const RGBA &v) { return glm::vec4(v); }
+  static inline RGBA store(const Acc &v) { return RGBA(glm::clamp(v + 0.5f, 0.f, 255.f)); }
+};
+
+template<>
+struct MipTexelTraits<RGBA16F> {
+  using Acc = glm::vec4;
+  static inline Acc load(const RGBA16F &v) { return glm::vec4(v); }
+  static inline RGBA16F store(const Acc &v) { return RGBA16F(v); }
+};
+
+// box filter downsampling of row major images, dst size is max(1, src >> 1) on each axis.
+// even axis: 2 taps (1/2, 1/2). odd axis (n = dst size, src = 2n + 1): 3 taps weighted
+// (n - i, n, i + 1) / (2n + 1), the exact box footprint, so no source texel is dropped
+class MipmapSoft {
+ public:
+  template<typename T>
+  static void downsample(const T *src, int srcW, int srcH, T *dst, int dstW, int dstH) {
+    auto rows = [&](size_t begin, size_t end, size_t) {
+      downsampleRows(src, srcW, srcH, dst, dstW, dstH, (int) begin, (int) end);
+    };
+    if (dstW * dstH < MIPMAP_PARALLEL_MIN_PIXELS) {
+      rows(0, dstH, 0);
+      return;
+    }
+    size_t grain = std::max(1, MIPMAP_TASK_PIXELS / dstW);
+    ThreadPool::shared().parallelFor(0, dstH, grain, rows);
+  }
+
+ private:
+  struct AxisTaps {
+    int idx[3];
+    float weight[3];
+    int cnt;
+  };
+
+  static inline AxisTaps axisTaps(int i, int srcN, int dstN) {
+    AxisTaps taps;
+    if (srcN == 1) {
+      taps.cnt = 1;
+      taps.idx[0] = 0;
+      taps.weight[0] = 1.f;
+    } else if ((srcN & 1) == 0) {
+      taps.cnt = 2;
+      taps.idx[0] = 2 * i;
+      taps.idx[1] = 2 * i + 1;
+      taps.weight[0] = taps.weight[1] = 0.5f;
+    } else {
+      float invN = 1.f / (float) srcN;
+      taps.cnt = 3;
+      taps.idx[0] = 2 * i;
+      taps.idx[1] = 2 * i + 1;
+      taps.idx[2] = 2 * i + 2;
+      taps.weight[0] = (float) (dstN - i) * invN;
+      taps.weight[1] = (float) dstN * invN;
+      taps.weight[2] = (float) (i + 1) * invN;
+    }
+    return taps;
+  }
+
+  // 2x2 box over whole RGBA row with SIMD, return dst pixels done
+  static inline int downsampleRowBox(const RGBA *row0, const RGBA *row1, RGBA *out, int dstW) {
+    int x = 0;
+#ifdef SOFTGL_SIMD_OPT
+    // 4 dst pixels per iteration, widened to 16 bit: (a + b + c + d + 2) >> 2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i two = _mm_set1_epi16(2);
+    for (; x + 4 <= dstW; x += 4) {
+      __m128i a0 = _mm_loadu_si128((const __m128i *) (row0 + 2 * x));
+      __m128i a1 = _mm_loadu_si128((const __m128i *) (row0 + 2 * x + 4));
+      __m128i b0 = _mm_loadu_si128((const __m128i *) (row1 + 2 * x));
+      __m128i b1 = _mm_loadu_si128((const __m128i *) (row1 + 2 * x + 4));
+
+      // vertical sums of src pixel pairs (0, 1), (2, 3), (4, 5), (6, 7)
+      __m128i s01 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+      __m128i s23 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+      __m128i s45 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+      __m128i s67 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+      // horizontal sums: even src pixel + odd src pixel
+      __m128i h0 = _mm_add_epi16(_mm_unpacklo_epi64(s01, s23), _mm_unpackhi_epi64(s01, s23));
+      __m128i h1 = _mm_add_epi16(_mm_unpacklo_epi64(s45, s67), _mm_unpackhi_epi64(s45, s67));
+      h0 = _mm_srli_epi16(_mm_add_epi16(h0, two), 2);
+      h1 = _mm_srli_epi16(_mm_add_epi16(h1, two), 2);
+      _mm_storeu_si128((__m128i *) (out + x), _mm_packus_epi16(h0, h1));
+    }
+#endif
+    return x;
+  }
+
+  template<typename T>
+  static void downsampleRows(const T *src, int srcW, int srcH, T *dst, int dstW, int dstH, int rowBegin, int rowEnd) {
+    using Traits = MipTexelTraits<T>;
+    using Acc = typename Traits::Acc;
+    bool box = (srcW & 1) == 0 && (srcH & 1) == 0;
+
+    for (int y = rowBegin; y < rowEnd; y++) {
+      T *out = dst + (size_t) y * dstW;
+      if (box) {
+        const T *row0 = src + (size_t) (2 * y) * srcW;
+        const T *row1 = row0 + srcW;
+        // SIMD path only for RGBA, other formats start from 0 (branch is resolved at compile time)
+        int x = std::is_same<T, RGBA>::value
+                ? downsampleRowBox((const RGBA *) row0, (const RGBA *) row1, (RGBA *) out, dstW) : 0;
+        for (; x < dstW; x++) {
+          Acc sum = Traits::load(row0[2 * x]) + Traits::load(row0[2 * x + 1])
+              + Traits::load(row1[2 * x]) + Traits::load(row1[2 * x + 1]);
+          out[x] = Traits::store(sum * 0.25f);
+        }
+        continue;
+      }
+
+      AxisTaps tapsY = axisTaps(y, srcH, dstH);
+      for (int x = 0; x < dstW; x++) {
+        out[x] = filterTaps(src, srcW, axisTaps(x, srcW, dstW), tapsY);
+      }
+    }
+  }
+
+  template<typename T>
+  static inline T filterTaps(const T *src, int srcW, const AxisTaps &tapsX, const AxisTaps &tapsY) {
+    using Traits = MipTexelTraits<T>;
+    using Acc = typename Traits::Acc;
+    Acc sum = Acc(0);
+    for (int j = 0; j < tapsY.cnt; j++) {
+      const T *row = src + (size_t) tapsY.idx[j] * srcW;
+      Acc rowSum = Acc(0);
+      for (int i = 0; i < tapsX.cnt; i++) {
+        rowSum += Traits::load(row[tapsX.idx[i]]) * tapsX.weight[i];
+      }
+      sum += rowSum * tapsY.weight[j];
+    }
+    return Traits::store(sum);
+  }
+
+#ifdef SOFTGL_SIMD_OPT
+  static inline RGBA filterTaps(const RGBA *src, int srcW, const AxisTaps &tapsX, const AxisTaps &tapsY) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128 sum = _mm_setzero_ps();
+    for (int j = 0; j < tapsY.cnt; j++) {
+      const RGBA *row = src + (size_t) tapsY.idx[j] * srcW;
+      __m128 rowSum = _mm_setzero_ps();
+      for (int i = 0; i < tapsX.cnt; i++) {
+        int texel;
+        memcpy(&texel, &row[tapsX.idx[i]], sizeof(int));
+        __m128i t = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(texel), zero), zero);
+        rowSum = _mm_add_ps(rowSum, _mm_mul_ps(_mm_cvtepi32_ps(t), _mm_set1_ps(tapsX.weight[i])));
+      }
+      sum = _mm_add_ps(sum, _mm_mul_ps(rowSum, _mm_set1_ps(tapsY.weight[j])));
+    }
+    // weights sum to 1, result in [0, 255], round to nearest
+    __m128i c = _mm_cvtps_epi32(sum);
+    c = _mm_packs_epi32(c, c);
+    int texel = _mm_cvtsi128_si32(_mm_packus_epi16(c, c));
+    RGBA ret;
+    memcpy(&ret, &texel, sizeof(int));
+    return ret;
+  }
+#endif
+};
+
+}
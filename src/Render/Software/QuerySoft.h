@@ -0,0 +1,28 @@
+/*
+ * SoftGLRender
+ * @author 	: keith@robot9.me
+ *
+ */
+
+#pragma once
+
+#include "Base/UUID.h"
+#include "Render/Query.h"
+
+namespace SoftGL {
+
+class QueryObjectSoft : public QueryObject {
+ public:
+  int getId() const override {
+    return uuid_.get();
+  }
+
+ public:
+  uint64_t samplesPassed = 0;
+  bool available = false;
+
+ private:
+  UUID<QueryObjectSoft> uuid_;
+};
+
+}
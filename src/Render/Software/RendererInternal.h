@@ -7,6 +7,7 @@
 #pragma once
 
 #include "Base/MemoryUtils.h"
+#include "Render/PipelineStatistics.h"
 #include "Render/Software/ShaderProgramSoft.h"
 
 namespace SoftGL {
@@ -37,9 +38,6 @@ struct VertexHolder {
   int clipMask = 0;
   glm::aligned_vec4 clipPos = glm::vec4(0.f);     // clip space position
   glm::aligned_vec4 fragPos = glm::vec4(0.f);     // screen space position
-
-  std::shared_ptr<uint8_t> vertexHolder = nullptr;
-  std::shared_ptr<float> varyingsHolder = nullptr;
 };
 
 struct PrimitiveHolder {
@@ -56,6 +54,24 @@ class SampleContext {
   glm::aligned_vec4 barycentric = glm::aligned_vec4(0.f);
 };
 
+// fixed capacity array, avoid heap allocation for small per-pixel data
+template<typename T, size_t N>
+class FixedArray {
+ public:
+  inline void resize(size_t cnt) { size_ = cnt <= N ? cnt : N; }
+  inline size_t size() const { return size_; }
+
+  inline T &operator[](size_t idx) { return data_[idx]; }
+  inline const T &operator[](size_t idx) const { return data_[idx]; }
+
+  inline T *begin() { return data_; }
+  inline T *end() { return data_ + size_; }
+
+ private:
+  T data_[N];
+  size_t size_ = 0;
+};
+
 class PixelContext {
  public:
   inline static glm::vec2 *GetSampleLocation4X() {
@@ -126,7 +142,7 @@ class PixelContext {
  public:
   bool inside = false;
   float *varyingsFrag = nullptr;
-  std::vector<SampleContext> samples;
+  FixedArray<SampleContext, 5> samples;   // 4x msaa + center
   SampleContext *sampleShading = nullptr;
   int sampleCount = 0;
   int coverage = 0;
@@ -134,13 +150,11 @@ class PixelContext {
 
 class PixelQuadContext {
  public:
-  void SetVaryingsSize(size_t size) {
-    if (varyingsAlignedCnt_ != size) {
-      varyingsAlignedCnt_ = size;
-      varyingsPool_ = MemoryUtils::makeAlignedBuffer<float>(4 * varyingsAlignedCnt_);
-      for (int i = 0; i < 4; i++) {
-        pixels[i].varyingsFrag = varyingsPool_.get() + i * varyingsAlignedCnt_;
-      }
+  // varyings of 4 pixels, valid until the arena reset
+  void AllocVaryings(LinearArena &arena, size_t size) {
+    float *varyingsPool = arena.allocArray<float>(4 * size);
+    for (int i = 0; i < 4; i++) {
+      pixels[i].varyingsFrag = varyingsPool ? varyingsPool + i * size : nullptr;
     }
   }
 
@@ -178,11 +192,10 @@ class PixelQuadContext {
   bool frontFacing = true;
 
   // shader program
-  std::shared_ptr<ShaderProgramSoft> shaderProgram = nullptr;
+  ShaderProgramSoft *shaderProgram = nullptr;
 
- private:
-  size_t varyingsAlignedCnt_ = 0;
-  std::shared_ptr<float> varyingsPool_ = nullptr;
+  // per-thread statistics, merged after raster tasks finished
+  PipelineStatistics stats;
 };
 
 }
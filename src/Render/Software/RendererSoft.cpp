@@ -15,10 +15,40 @@
 #include "BlendSoft.h"
 #include "DepthSoft.h"
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
 namespace SoftGL {
 
 #define RASTER_MULTI_THREAD
 
+// vertex shader runs in parallel when vertex count exceeds this
+#define VERTEX_PARALLEL_MIN_CNT 2048
+#define VERTEX_PARALLEL_GRAIN 512
+
+// clear in row bands on thread pool when area exceeds this
+#define CLEAR_PARALLEL_MIN_PIXELS (256 * 256)
+#define CLEAR_PARALLEL_GRAIN_ROWS 16
+
+// triangle clipped by 6 frustum planes has at most 3 + 6 vertexes, +1 for the wrap-around vertex
+#define CLIP_POLYGON_MAX_VERTEX 10
+
+static inline uint64_t readCycleCounter() {
+  return __rdtsc();
+}
+
+// color attachment conversion, RGBA8 is normalized, float formats keep hdr range
+static inline glm::vec4 loadColor(const RGBA &c) { return glm::vec4(c) / 255.f; }
+static inline glm::vec4 loadColor(const RGBA16F &c) { return glm::vec4(c); }
+static inline glm::vec4 loadColor(const RGBA32F &c) { return c; }
+
+static inline void storeColor(RGBA &dst, const glm::vec4 &c) { dst = c * 255.f; }
+static inline void storeColor(RGBA16F &dst, const glm::vec4 &c) { dst = RGBA16F(c); }
+static inline void storeColor(RGBA32F &dst, const glm::vec4 &c) { dst = c; }
+
 // framebuffer
 std::shared_ptr<FrameBuffer> RendererSoft::createFrameBuffer(bool offscreen) {
   return std::make_shared<FrameBufferSoft>(offscreen);
@@ -29,6 +59,8 @@ std::shared_ptr<Texture> RendererSoft::createTexture(const TextureDesc &desc) {
   switch (desc.format) {
     case TextureFormat_RGBA8:   return std::make_shared<TextureSoft<RGBA>>(desc);
     case TextureFormat_FLOAT32: return std::make_shared<TextureSoft<float>>(desc);
+    case TextureFormat_RGBA16F: return std::make_shared<TextureSoft<RGBA16F>>(desc);
+    case TextureFormat_RGBA32F: return std::make_shared<TextureSoft<RGBA32F>>(desc);
   }
   return nullptr;
 }
@@ -58,33 +90,46 @@ std::shared_ptr<UniformSampler> RendererSoft::createUniformSampler(const std::st
 }
 
 // pipeline
-void RendererSoft::beginRenderPass(std::shared_ptr<FrameBuffer> &frameBuffer, const ClearStates &states) {
+void RendererSoft::beginRenderPass(std::shared_ptr<FrameBuffer> &frameBuffer, const ClearStates &states,
+                                   const Rect2D &renderArea) {
   fbo_ = dynamic_cast<FrameBufferSoft *>(frameBuffer.get());
 
   if (!fbo_) {
     return;
   }
 
-  fboColor_ = fbo_->getColorBuffer();
+  updateColorBuffers();
   fboDepth_ = fbo_->getDepthBuffer();
+  fboCost_ = (shadingCostMode_ != ShadingCost_NONE) ? fbo_->getShadingCostBuffer() : nullptr;
+  updateFboLayout();
+
+  // render area
+  Rect2D fboRect{};
+  if (fboColorCnt_ > 0) {
+    fboRect.width = fboColors_[0].width;
+    fboRect.height = fboColors_[0].height;
+  } else if (fboDepth_) {
+    fboRect.width = fboDepth_->width;
+    fboRect.height = fboDepth_->height;
+  }
+  renderArea_ = renderArea.empty() ? fboRect : renderArea.intersect(fboRect);
 
-  if (states.colorFlag && fboColor_) {
-    RGBA color = RGBA(states.clearColor.r * 255,
-                      states.clearColor.g * 255,
-                      states.clearColor.b * 255,
-                      states.clearColor.a * 255);
-    if (fboColor_->multiSample) {
-      fboColor_->bufferMs4x->setAll(glm::tvec4<RGBA>(color));
-    } else {
-      fboColor_->buffer->setAll(color);
+  // clear only inside render area
+  if (states.colorFlag && fboCost_) {
+    clearBufferRect(*fboCost_->buffer, 0.f);
+  }
+
+  if (states.colorFlag) {
+    for (int i = 0; i < fboColorCnt_; i++) {
+      clearColorBuffer(fboColors_[i], states.clearColor);
     }
   }
 
   if (states.depthFlag && fboDepth_) {
     if (fboDepth_->multiSample) {
-      fboDepth_->bufferMs4x->setAll(glm::tvec4<float>(states.clearDepth));
+      clearBufferRect(*fboDepth_->bufferMs4x, glm::tvec4<float>(states.clearDepth));
     } else {
-      fboDepth_->buffer->setAll(states.clearDepth);
+      clearBufferRect(*fboDepth_->buffer, states.clearDepth);
     }
   }
 }
@@ -138,18 +183,48 @@ void RendererSoft::draw() {
     return;
   }
 
-  fboColor_ = fbo_->getColorBuffer();
+  drawStats_.reset();
+
+  // conditional rendering
+  if (conditionQuery_ && conditionQuery_->available && conditionQuery_->samplesPassed == 0) {
+    return;
+  }
+  drawStats_.drawCalls = 1;
+
+  updateColorBuffers();
   fboDepth_ = fbo_->getDepthBuffer();
+  fboCost_ = (shadingCostMode_ != ShadingCost_NONE) ? fbo_->getShadingCostBuffer() : nullptr;
+  updateFboLayout();
+  fragDataCnt_ = std::min(shaderProgram_->getFragDataCount(), fboColorCnt_);
   primitiveType_ = renderState_->primitiveType;
 
-  if (fboColor_) {
-    rasterSamples_ = fboColor_->sampleCnt;
+  // raster area
+  Rect2D viewportRect;
+  viewportRect.x = (int) viewport_.x;
+  viewportRect.y = (int) viewport_.y;
+  viewportRect.width = (int) viewport_.width;
+  viewportRect.height = (int) viewport_.height;
+  rasterRect_ = renderArea_.intersect(viewportRect);
+  if (renderState_->scissorTest) {
+    rasterRect_ = rasterRect_.intersect(renderState_->scissor);
+  }
+  if (rasterRect_.empty()) {
+    return;
+  }
+
+  if (fboColorCnt_ > 0) {
+    rasterSamples_ = fboColors_[0].sampleCnt;
   } else if (fboDepth_) {
     rasterSamples_ = fboDepth_->sampleCnt;
   } else {
     rasterSamples_ = 1;
   }
 
+  // draw scratch of previous draw is dead
+  drawArena_.reset();
+  vertexes_.bind(&drawArena_);
+  primitives_.bind(&drawArena_);
+
   processVertexShader();
   processPrimitiveAssembly();
   processClipping();
@@ -158,23 +233,92 @@ void RendererSoft::draw() {
   processFaceCulling();
   processRasterization();
 
-  if (fboColor_ && fboColor_->multiSample) {
-    multiSampleResolve();
+  for (int i = 0; i < fboColorCnt_; i++) {
+    auto &colorBuffer = fboColors_[i];
+    if (!colorBuffer.multiSample) {
+      continue;
+    }
+    switch (colorBuffer.format) {
+      case TextureFormat_RGBA8:   multiSampleResolve(*colorBuffer.rgba8);   break;
+      case TextureFormat_RGBA16F: multiSampleResolve(*colorBuffer.rgba16f); break;
+      case TextureFormat_RGBA32F: multiSampleResolve(*colorBuffer.rgba32f); break;
+      default:
+        break;
+    }
   }
+
+  if (activeQuery_) {
+    activeQuery_->samplesPassed += drawStats_.samplesWritten;
+  }
+  frameStats_ += drawStats_;
 }
 
-void RendererSoft::endRenderPass() {}
+void RendererSoft::endRenderPass() {
+  for (auto &arena : threadArenas_) {
+    arena.reset();
+  }
+}
 
 void RendererSoft::waitIdle() {}
 
+void RendererSoft::resetFrameStatistics() {
+  frameStats_.reset();
+}
+
+const PipelineStatistics *RendererSoft::getDrawStatistics() {
+  return &drawStats_;
+}
+
+const PipelineStatistics *RendererSoft::getFrameStatistics() {
+  return &frameStats_;
+}
+
+std::shared_ptr<QueryObject> RendererSoft::createQuery() {
+  return std::make_shared<QueryObjectSoft>();
+}
+
+void RendererSoft::beginQuery(std::shared_ptr<QueryObject> &query) {
+  activeQuery_ = dynamic_cast<QueryObjectSoft *>(query.get());
+  if (activeQuery_) {
+    activeQuery_->samplesPassed = 0;
+    activeQuery_->available = false;
+  }
+}
+
+void RendererSoft::endQuery(std::shared_ptr<QueryObject> &query) {
+  auto *querySoft = dynamic_cast<QueryObjectSoft *>(query.get());
+  if (!querySoft || querySoft != activeQuery_) {
+    LOGE("endQuery failed: query not active");
+    return;
+  }
+  activeQuery_->available = true;
+  activeQuery_ = nullptr;
+}
+
+bool RendererSoft::getQueryResult(std::shared_ptr<QueryObject> &query, uint64_t &samples) {
+  auto *querySoft = dynamic_cast<QueryObjectSoft *>(query.get());
+  if (!querySoft || !querySoft->available) {
+    return false;
+  }
+  samples = querySoft->samplesPassed;
+  return true;
+}
+
+void RendererSoft::beginConditionalRender(std::shared_ptr<QueryObject> &query) {
+  conditionQuery_ = dynamic_cast<QueryObjectSoft *>(query.get());
+}
+
+void RendererSoft::endConditionalRender() {
+  conditionQuery_ = nullptr;
+}
+
 void RendererSoft::processVertexShader() {
   // init shader varyings
   varyingsCnt_ = shaderProgram_->getShaderVaryingsSize() / sizeof(float);
   varyingsAlignedSize_ = MemoryUtils::alignedSize(varyingsCnt_ * sizeof(float));
   varyingsAlignedCnt_ = varyingsAlignedSize_ / sizeof(float);
 
-  varyings_ = MemoryUtils::makeAlignedBuffer<float>(vao_->vertexCnt * varyingsAlignedCnt_);
-  float *varyingBuffer = varyings_.get();
+  float *varyingBuffer = drawArena_.allocArray<float>(vao_->vertexCnt * varyingsAlignedCnt_);
 
   uint8_t *vertexPtr = vao_->vertexes.data();
   vertexes_.resize(vao_->vertexCnt);
@@ -184,9 +328,30 @@ void RendererSoft::processVertexShader() {
     holder.index = idx;
     holder.vertex = vertexPtr;
     holder.varyings = (varyingsAlignedSize_ > 0) ? (varyingBuffer + idx * varyingsAlignedCnt_) : nullptr;
-    vertexShaderImpl(holder);
     vertexPtr += vao_->vertexStride;
   }
+
+  // point size comes from last shaded vertex, keep points serial
+#ifdef RASTER_MULTI_THREAD
+  if (vao_->vertexCnt >= VERTEX_PARALLEL_MIN_CNT && primitiveType_ != Primitive_POINT) {
+    // one shader program per thread, non-worker thread id is getThreadCnt()
+    for (size_t i = 0; i <= threadPool_.getThreadCnt(); i++) {
+      shaderProgram_->getThreadClone(i);
+    }
+    threadPool_.parallelFor(0, vao_->vertexCnt, VERTEX_PARALLEL_GRAIN, [&](size_t begin, size_t end, size_t threadId) {
+      auto *program = shaderProgram_->getThreadClone(threadId);
+      for (size_t idx = begin; idx < end; idx++) {
+        vertexShaderExec(vertexes_[idx], program);
+      }
+    }, rasterTasks_.getPriority());
+    drawStats_.vertexShaderInvocations += vao_->vertexCnt;
+    return;
+  }
+#endif
+
+  for (auto &holder : vertexes_) {
+    vertexShaderImpl(holder);
+  }
 }
 
 void RendererSoft::processPrimitiveAssembly() {
@@ -212,9 +377,11 @@ void RendererSoft::processClipping() {
     }
     switch (primitiveType_) {
       case Primitive_POINT:
+        drawStats_.clippingInvocations++;
         clippingPoint(primitive);
         break;
       case Primitive_LINE:
+        drawStats_.clippingInvocations++;
         clippingLine(primitive);
         break;
       case Primitive_TRIANGLE:
@@ -222,9 +389,8 @@ void RendererSoft::processClipping() {
         if (renderState_->polygonMode != PolygonMode_FILL) {
           continue;
         }
-        std::vector<PrimitiveHolder> appendPrimitives;
-        clippingTriangle(primitive, appendPrimitives);
-        primitives_.insert(primitives_.end(), appendPrimitives.begin(), appendPrimitives.end());
+        drawStats_.clippingInvocations++;
+        clippingTriangle(i);
         break;
     }
   }
@@ -239,6 +405,7 @@ void RendererSoft::processClipping() {
     if (primitive.discard) {
       continue;
     }
+    drawStats_.clippingPrimitives++;
     switch (primitiveType_) {
       case Primitive_POINT:
         vertexes_[primitive.indices[0]].discard = false;
@@ -294,6 +461,9 @@ void RendererSoft::processFaceCulling() {
 
     if (renderState_->cullFace) {
       triangle.discard = !triangle.frontFacing;  // discard back face
+      if (triangle.discard) {
+        drawStats_.culledPrimitives++;
+      }
     }
   }
 }
@@ -305,6 +475,7 @@ void RendererSoft::processRasterization() {
         if (primitive.discard) {
           continue;
         }
+        drawStats_.primitivesEmitted++;
         auto *vert0 = &vertexes_[primitive.indices[0]];
         rasterizationPoint(vert0, pointSize_);
       }
@@ -314,16 +485,21 @@ void RendererSoft::processRasterization() {
         if (primitive.discard) {
           continue;
         }
+        drawStats_.primitivesEmitted++;
         auto *vert0 = &vertexes_[primitive.indices[0]];
         auto *vert1 = &vertexes_[primitive.indices[1]];
         rasterizationLine(vert0, vert1, renderState_->lineWidth);
       }
       break;
     case Primitive_TRIANGLE:
-      threadQuadCtx_.resize(threadPool_.getThreadCnt());
-      for (auto &ctx : threadQuadCtx_) {
-        ctx.SetVaryingsSize(varyingsAlignedCnt_);
-        ctx.shaderProgram = shaderProgram_->clone();
+      // non-worker thread id is getThreadCnt(), tasks may run on pushing thread when queues are full
+      threadQuadCtx_.resize(threadPool_.getThreadCnt() + 1);
+      threadArenas_.resize(threadQuadCtx_.size());
+      for (size_t i = 0; i < threadQuadCtx_.size(); i++) {
+        auto &ctx = threadQuadCtx_[i];
+        ctx.stats.reset();
+        ctx.AllocVaryings(threadArenas_[i], varyingsAlignedCnt_);
+        ctx.shaderProgram = shaderProgram_->getThreadClone(i);
         ctx.shaderProgram->prepareFragmentShader();
 
         // setup derivative
@@ -334,7 +510,12 @@ void RendererSoft::processRasterization() {
         df_ctx.p3 = ctx.pixels[3].varyingsFrag;
       }
       rasterizationPolygons(primitives_);
-      threadPool_.waitTasksFinish();
+      threadPool_.waitGroup(rasterTasks_);
+
+      // merge per-thread statistics
+      for (auto &ctx : threadQuadCtx_) {
+        drawStats_ += ctx.stats;
+      }
       break;
   }
 }
@@ -343,7 +524,7 @@ void RendererSoft::processFragmentShader(glm::vec4 &screenPos,
                                          bool front_facing,
                                          void *varyings,
                                          ShaderProgramSoft *shader) {
-  if (!fboColor_) {
+  if (fboColorCnt_ == 0) {
     return;
   }
 
@@ -355,25 +536,31 @@ void RendererSoft::processFragmentShader(glm::vec4 &screenPos,
   shader->execFragmentShader();
 }
 
-void RendererSoft::processPerSampleOperations(int x, int y, float depth, const glm::vec4 &color, int sample) {
+template<typename L>
+bool RendererSoft::processPerSampleOperations(int x, int y, float depth, const glm::vec4 *colors, int sample) {
   // depth test
-  if (!processDepthTest(x, y, depth, sample, false)) {
-    return;
+  if (!processDepthTest<L>(x, y, depth, sample, false)) {
+    return false;
   }
 
-  if (!fboColor_) {
-    return;
+  if (!renderState_->colorMask) {
+    return true;
   }
 
-  glm::vec4 color_clamp = glm::clamp(color, 0.f, 1.f);
-
-  // color blending
-  processColorBlending(x, y, color_clamp, sample);
-
-  // write final color to fbo
-  setFrameColor(x, y, color_clamp * 255.f, sample);
+  for (int i = 0; i < fboColorCnt_; i++) {
+    auto &colorBuffer = fboColors_[i];
+    switch (colorBuffer.format) {
+      case TextureFormat_RGBA8:   processColorWrite<L>(*colorBuffer.rgba8, x, y, colors[i], sample);   break;
+      case TextureFormat_RGBA16F: processColorWrite<L>(*colorBuffer.rgba16f, x, y, colors[i], sample); break;
+      case TextureFormat_RGBA32F: processColorWrite<L>(*colorBuffer.rgba32f, x, y, colors[i], sample); break;
+      default:
+        break;
+    }
+  }
+  return true;
 }
 
+template<typename L>
 bool RendererSoft::processDepthTest(int x, int y, float depth, int sample, bool skipWrite) {
   if (!renderState_->depthTest || !fboDepth_) {
     return true;
@@ -383,7 +570,7 @@ bool RendererSoft::processDepthTest(int x, int y, float depth, int sample, bool
   depth = glm::clamp(depth, viewport_.absMinDepth, viewport_.absMaxDepth);
 
   // depth comparison
-  float *zPtr = getFrameDepth(x, y, sample);
+  float *zPtr = getFrameDepth<L>(x, y, sample);
   if (zPtr && DepthTest(depth, *zPtr, renderState_->depthFunc)) {
     // depth attachment writes
     if (!skipWrite && renderState_->depthMask) {
@@ -394,15 +581,42 @@ bool RendererSoft::processDepthTest(int x, int y, float depth, int sample, bool
   return false;
 }
 
-void RendererSoft::processColorBlending(int x, int y, glm::vec4 &color, int sample) {
+template<typename L, typename T>
+void RendererSoft::processColorWrite(ImageBufferSoft<T> &colorBuffer, int x, int y, glm::vec4 color, int sample) {
+  T *ptr = getFrameColor<L>(colorBuffer, x, y, sample);
+  if (!ptr) {
+    return;
+  }
+
+  // clamp fixed point format only
+  if (std::is_same<T, RGBA>::value) {
+    color = glm::clamp(color, 0.f, 1.f);
+  }
+
+  // color blending
   if (renderState_->blend) {
-    glm::vec4 &srcColor = color;
-    glm::vec4 dstColor = glm::vec4(0.f);
-    auto *ptr = getFrameColor(x, y, sample);
-    if (ptr) {
-      dstColor = glm::vec4(*ptr) / 255.f;
-    }
-    color = calcBlendColor(srcColor, dstColor, renderState_->blendParams);
+    glm::vec4 dstColor = loadColor(*ptr);
+    color = calcBlendColor(color, dstColor, renderState_->blendParams);
+  }
+
+  // write final color to fbo
+  storeColor(*ptr, color);
+}
+
+void RendererSoft::processShadingCost(int x, int y, uint64_t cycleStart) {
+  float *ptr = fboCost_->buffer->get(x, y);
+  if (!ptr) {
+    return;
+  }
+  switch (shadingCostMode_) {
+    case ShadingCost_INVOCATIONS:
+      *ptr += 1.f;
+      break;
+    case ShadingCost_CYCLES:
+      *ptr += (float) (readCycleCounter() - cycleStart);
+      break;
+    default:
+      break;
   }
 }
 
@@ -486,7 +700,8 @@ void RendererSoft::clippingLine(PrimitiveHolder &line, bool postVertexProcess) {
   }
 }
 
-void RendererSoft::clippingTriangle(PrimitiveHolder &triangle, std::vector<PrimitiveHolder> &appendPrimitives) {
+void RendererSoft::clippingTriangle(size_t triangleIdx) {
+  PrimitiveHolder &triangle = primitives_[triangleIdx];
   auto *v0 = &vertexes_[triangle.indices[0]];
   auto *v1 = &vertexes_[triangle.indices[1]];
   auto *v2 = &vertexes_[triangle.indices[2]];
@@ -497,37 +712,40 @@ void RendererSoft::clippingTriangle(PrimitiveHolder &triangle, std::vector<Primi
   }
 
   bool fullClip = false;
-  std::vector<size_t> indicesIn;
-  std::vector<size_t> indicesOut;
+  size_t indicesBuffer[2][CLIP_POLYGON_MAX_VERTEX];
+  size_t *indicesIn = indicesBuffer[0];
+  size_t *indicesOut = indicesBuffer[1];
+  size_t inCnt = 0;
+  size_t outCnt = 0;
 
-  indicesIn.push_back(v0->index);
-  indicesIn.push_back(v1->index);
-  indicesIn.push_back(v2->index);
+  indicesIn[inCnt++] = v0->index;
+  indicesIn[inCnt++] = v1->index;
+  indicesIn[inCnt++] = v2->index;
 
   for (int planeIdx = 0; planeIdx < 6; planeIdx++) {
     if (mask & FrustumClipMaskArray[planeIdx]) {
-      if (indicesIn.size() < 3) {
+      if (inCnt < 3) {
         fullClip = true;
         break;
       }
-      indicesOut.clear();
+      outCnt = 0;
       size_t idxPre = indicesIn[0];
       float dPre = glm::dot(FrustumClipPlane[planeIdx], vertexes_[idxPre].clipPos);
 
-      indicesIn.push_back(idxPre);
-      for (int i = 1; i < indicesIn.size(); i++) {
+      indicesIn[inCnt++] = idxPre;
+      for (int i = 1; i < inCnt; i++) {
         size_t idx = indicesIn[i];
         float d = glm::dot(FrustumClipPlane[planeIdx], vertexes_[idx].clipPos);
 
         if (dPre >= 0) {
-          indicesOut.push_back(idxPre);
+          indicesOut[outCnt++] = idxPre;
         }
 
         if (std::signbit(dPre) != std::signbit(d)) {
           float t = d < 0 ? dPre / (dPre - d) : -dPre / (d - dPre);
           // create new vertex
           auto vertIdx = clippingNewVertex(idxPre, idx, t);
-          indicesOut.push_back(vertIdx);
+          indicesOut[outCnt++] = vertIdx;
         }
 
         idxPre = idx;
@@ -535,10 +753,11 @@ void RendererSoft::clippingTriangle(PrimitiveHolder &triangle, std::vector<Primi
       }
 
       std::swap(indicesIn, indicesOut);
+      std::swap(inCnt, outCnt);
     }
   }
 
-  if (fullClip || indicesIn.empty()) {
+  if (fullClip || inCnt == 0) {
     triangle.discard = true;
     return;
   }
@@ -547,18 +766,19 @@ void RendererSoft::clippingTriangle(PrimitiveHolder &triangle, std::vector<Primi
   triangle.indices[1] = indicesIn[1];
   triangle.indices[2] = indicesIn[2];
 
-  for (int i = 3; i < indicesIn.size(); i++) {
-    appendPrimitives.emplace_back();
-    PrimitiveHolder &ph = appendPrimitives.back();
+  // triangle reference is invalid once primitives_ grows
+  bool frontFacing = triangle.frontFacing;
+  for (int i = 3; i < inCnt; i++) {
+    PrimitiveHolder &ph = primitives_.emplace_back();
     ph.discard = false;
     ph.indices[0] = indicesIn[0];
     ph.indices[1] = indicesIn[i - 1];
     ph.indices[2] = indicesIn[i];
-    ph.frontFacing = triangle.frontFacing;
+    ph.frontFacing = frontFacing;
   }
 }
 
-void RendererSoft::rasterizationPolygons(std::vector<PrimitiveHolder> &primitives) {
+void RendererSoft::rasterizationPolygons(ArenaVector<PrimitiveHolder> &primitives) {
   switch (renderState_->polygonMode) {
     case PolygonMode_POINT:
       rasterizationPolygonsPoint(primitives);
@@ -572,7 +792,7 @@ void RendererSoft::rasterizationPolygons(std::vector<PrimitiveHolder> &primitive
   }
 }
 
-void RendererSoft::rasterizationPolygonsPoint(std::vector<PrimitiveHolder> &primitives) {
+void RendererSoft::rasterizationPolygonsPoint(ArenaVector<PrimitiveHolder> &primitives) {
   for (auto &triangle : primitives) {
     if (triangle.discard) {
       continue;
@@ -588,6 +808,7 @@ void RendererSoft::rasterizationPolygonsPoint(std::vector<PrimitiveHolder> &prim
       if (point.discard) {
         continue;
       }
+      drawStats_.primitivesEmitted++;
 
       // rasterization
       rasterizationPoint(&vertexes_[point.indices[0]], pointSize_);
@@ -595,7 +816,7 @@ void RendererSoft::rasterizationPolygonsPoint(std::vector<PrimitiveHolder> &prim
   }
 }
 
-void RendererSoft::rasterizationPolygonsLine(std::vector<PrimitiveHolder> &primitives) {
+void RendererSoft::rasterizationPolygonsLine(ArenaVector<PrimitiveHolder> &primitives) {
   for (auto &triangle : primitives) {
     if (triangle.discard) {
       continue;
@@ -612,6 +833,7 @@ void RendererSoft::rasterizationPolygonsLine(std::vector<PrimitiveHolder> &primi
       if (line.discard) {
         continue;
       }
+      drawStats_.primitivesEmitted++;
 
       // rasterization
       rasterizationLine(&vertexes_[line.indices[0]],
@@ -621,11 +843,12 @@ void RendererSoft::rasterizationPolygonsLine(std::vector<PrimitiveHolder> &primi
   }
 }
 
-void RendererSoft::rasterizationPolygonsTriangle(std::vector<PrimitiveHolder> &primitives) {
+void RendererSoft::rasterizationPolygonsTriangle(ArenaVector<PrimitiveHolder> &primitives) {
   for (auto &triangle : primitives) {
     if (triangle.discard) {
       continue;
     }
+    drawStats_.primitivesEmitted++;
     rasterizationTriangle(&vertexes_[triangle.indices[0]],
                           &vertexes_[triangle.indices[1]],
                           &vertexes_[triangle.indices[2]],
@@ -634,7 +857,7 @@ void RendererSoft::rasterizationPolygonsTriangle(std::vector<PrimitiveHolder> &p
 }
 
 void RendererSoft::rasterizationPoint(VertexHolder *v, float pointSize) {
-  if (!fboColor_) {
+  if (fboColorCnt_ == 0) {
     return;
   }
 
@@ -643,17 +866,32 @@ void RendererSoft::rasterizationPoint(VertexHolder *v, float pointSize) {
   float top = v->fragPos.y - pointSize / 2.f + 0.5f;
   float bottom = top + pointSize;
 
+  // clamp to raster area
+  int xStart = std::max((int) left, rasterRect_.x);
+  int xEnd = std::min((int) right, rasterRect_.x + rasterRect_.width);
+  int yStart = std::max((int) top, rasterRect_.y);
+  int yEnd = std::min((int) bottom, rasterRect_.y + rasterRect_.height);
+
   glm::vec4 &screenPos = v->fragPos;
-  for (int x = (int) left; x < (int) right; x++) {
-    for (int y = (int) top; y < (int) bottom; y++) {
+  for (int x = xStart; x < xEnd; x++) {
+    for (int y = yStart; y < yEnd; y++) {
       screenPos.x = (float) x;
       screenPos.y = (float) y;
+      uint64_t cycleStart = fboCost_ ? readCycleCounter() : 0;
       processFragmentShader(screenPos, true, v->varyings, shaderProgram_);
+      drawStats_.fragmentShaderInvocations++;
+      if (fboCost_) {
+        processShadingCost(x, y, cycleStart);
+      }
       auto &builtIn = shaderProgram_->getShaderBuiltin();
       if (!builtIn.discard) {
+        glm::vec4 fragOutputs[MAX_COLOR_ATTACHMENTS];
+        getFragOutputs(shaderProgram_, fragOutputs);
         // TODO MSAA
         for (int idx = 0; idx < rasterSamples_; idx++) {
-          processPerSampleOperations(x, y, screenPos.z, builtIn.FragColor, idx);
+          if (processPerSampleOperations(x, y, screenPos.z, fragOutputs, idx)) {
+            drawStats_.samplesWritten++;
+          }
         }
       }
     }
@@ -695,9 +933,8 @@ void RendererSoft::rasterizationLine(VertexHolder *v0, VertexHolder *v1, float l
 
   int y = y0;
 
-  auto varyings = MemoryUtils::makeBuffer<float>(varyingsCnt_);
   VertexHolder pt{};
-  pt.varyings = varyings.get();
+  pt.varyings = drawArena_.allocArray<float>(varyingsCnt_);
 
   float t = 0;
   for (int x = x0; x <= x1; x++) {
@@ -721,7 +958,10 @@ void RendererSoft::rasterizationTriangle(VertexHolder *v0, VertexHolder *v1, Ver
   // TODO top-left rule
   VertexHolder *vert[3] = {v0, v1, v2};
   glm::aligned_vec4 screenPos[3] = {vert[0]->fragPos, vert[1]->fragPos, vert[2]->fragPos};
-  BoundingBox bounds = triangleBoundingBox(screenPos, viewport_.width, viewport_.height);
+  BoundingBox bounds = triangleBoundingBox(screenPos, rasterRect_);
+  if (bounds.max.x < bounds.min.x || bounds.max.y < bounds.min.y) {
+    return;
+  }
   bounds.min -= 1.f;
 
   auto blockSize = rasterBlockSize_;
@@ -731,11 +971,11 @@ void RendererSoft::rasterizationTriangle(VertexHolder *v0, VertexHolder *v1, Ver
   for (int blockY = 0; blockY < blockCntY; blockY++) {
     for (int blockX = 0; blockX < blockCntX; blockX++) {
 #ifdef RASTER_MULTI_THREAD
-      threadPool_.pushTask([&, vert, bounds, blockSize, blockX, blockY](int thread_id) {
+      threadPool_.pushTask(rasterTasks_, [&, vert, bounds, blockSize, blockX, blockY](int thread_id) {
         // init pixel quad
-        auto pixelQuad = threadQuadCtx_[thread_id];
+        auto &pixelQuad = threadQuadCtx_[thread_id];
 #else
-        auto pixelQuad = threadQuadCtx_[0];
+        auto &pixelQuad = threadQuadCtx_[0];
 #endif
         pixelQuad.frontFacing = frontFacing;
 
@@ -752,13 +992,23 @@ void RendererSoft::rasterizationTriangle(VertexHolder *v0, VertexHolder *v1, Ver
         pixelQuad.vertPosFlat[2] = {vertPos[0].z, vertPos[1].z, vertPos[2].z, 0.f};
         pixelQuad.vertPosFlat[3] = {vertPos[0].w, vertPos[1].w, vertPos[2].w, 0.f};
 
-        // block rasterization
+        // block rasterization, dispatch on attachment layout once per block
         int blockStartX = bounds.min.x + blockX * blockSize;
         int blockStartY = bounds.min.y + blockY * blockSize;
-        for (int y = blockStartY + 1; y < blockStartY + blockSize && y <= bounds.max.y; y += 2) {
-          for (int x = blockStartX + 1; x < blockStartX + blockSize && x <= bounds.max.x; x += 2) {
-            pixelQuad.Init((float) x, (float) y, rasterSamples_);
-            rasterizationPixelQuad(pixelQuad);
+        if (!fboLayoutUniform_) {
+          rasterizationBlock<AnyIndex>(pixelQuad, blockStartX, blockStartY, blockSize, bounds);
+        } else {
+          switch (fboLayout_) {
+            case Layout_Tiled:
+              rasterizationBlock<TiledIndex>(pixelQuad, blockStartX, blockStartY, blockSize, bounds);
+              break;
+            case Layout_Morton:
+              rasterizationBlock<MortonIndex>(pixelQuad, blockStartX, blockStartY, blockSize, bounds);
+              break;
+            case Layout_Linear:
+            default:
+              rasterizationBlock<LinearIndex>(pixelQuad, blockStartX, blockStartY, blockSize, bounds);
+              break;
           }
         }
 #ifdef RASTER_MULTI_THREAD
@@ -768,14 +1018,28 @@ void RendererSoft::rasterizationTriangle(VertexHolder *v0, VertexHolder *v1, Ver
   }
 }
 
+template<typename L>
+void RendererSoft::rasterizationBlock(PixelQuadContext &quad, int blockStartX, int blockStartY, int blockSize,
+                                      const BoundingBox &bounds) {
+  for (int y = blockStartY + 1; y < blockStartY + blockSize && y <= bounds.max.y; y += 2) {
+    for (int x = blockStartX + 1; x < blockStartX + blockSize && x <= bounds.max.x; x += 2) {
+      quad.Init((float) x, (float) y, rasterSamples_);
+      rasterizationPixelQuad<L>(quad);
+    }
+  }
+}
+
+template<typename L>
 void RendererSoft::rasterizationPixelQuad(PixelQuadContext &quad) {
   glm::aligned_vec4 *vert = quad.vertPosFlat;
   glm::aligned_vec4 &v0 = quad.vertPos[0];
 
   // barycentric
   for (auto &pixel : quad.pixels) {
+    // quad may cross raster area edge, still calculate barycentric for derivatives
+    bool inRect = rasterRect_.contains(pixel.samples[0].fboCoord.x, pixel.samples[0].fboCoord.y);
     for (auto &sample : pixel.samples) {
-      sample.inside = barycentric(vert, v0, sample.position, sample.barycentric);
+      sample.inside = barycentric(vert, v0, sample.position, sample.barycentric) && inRect;
     }
     pixel.InitCoverage();
     pixel.InitShadingSample();
@@ -783,6 +1047,7 @@ void RendererSoft::rasterizationPixelQuad(PixelQuadContext &quad) {
   if (!quad.CheckInside()) {
     return;
   }
+  quad.stats.quadsTested++;
 
   for (auto &pixel : quad.pixels) {
     for (auto &sample : pixel.samples) {
@@ -805,7 +1070,8 @@ void RendererSoft::rasterizationPixelQuad(PixelQuadContext &quad) {
 
   // early z
   if (earlyZ_ && renderState_->depthTest) {
-    if (!earlyZTest(quad)) {
+    if (!earlyZTest<L>(quad)) {
+      quad.stats.quadsEarlyZKilled++;
       return;
     }
   }
@@ -818,21 +1084,53 @@ void RendererSoft::rasterizationPixelQuad(PixelQuadContext &quad) {
                            varyingsCnt_,
                            pixel.sampleShading->barycentric);
   }
+  // new varyings, sampler lod is computed again by first fetch of the quad
+  quad.shaderProgram->getShaderBuiltin().dfCtx.lodCache.valid = false;
+
+  // coarse shading: pixels with same (index & groupMask) share one shading result
+  int rate = getQuadShadingRate(quad);
+  int groupMask = ((rate & ShadingRate_2X1) ? 0 : 1) | ((rate & ShadingRate_1X2) ? 0 : 2);
+  glm::vec4 fragColors[4][MAX_COLOR_ATTACHMENTS];
 
   // pixel shading
-  for (auto &pixel : quad.pixels) {
+  for (int i = 0; i < 4; i++) {
+    auto &pixel = quad.pixels[i];
     if (!pixel.inside) {
+      quad.stats.helperPixels++;
       continue;
     }
 
-    // fragment shader
-    processFragmentShader(pixel.sampleShading->position,
-                          quad.frontFacing,
-                          pixel.varyingsFrag,
-                          quad.shaderProgram.get());
+    // find shaded pixel in same group
+    int shaded = i;
+    if (groupMask != 3) {
+      for (int j = 0; j < i; j++) {
+        if (quad.pixels[j].inside && (j & groupMask) == (i & groupMask)) {
+          shaded = j;
+          break;
+        }
+      }
+    }
 
-    // sample coverage
-    auto &builtIn = quad.shaderProgram->getShaderBuiltin();
+    if (shaded == i) {
+      // fragment shader
+      uint64_t cycleStart = fboCost_ ? readCycleCounter() : 0;
+      processFragmentShader(pixel.sampleShading->position,
+                            quad.frontFacing,
+                            pixel.varyingsFrag,
+                            quad.shaderProgram);
+      quad.stats.fragmentShaderInvocations++;
+
+      // shading cost debug
+      if (fboCost_) {
+        processShadingCost(pixel.sampleShading->fboCoord.x, pixel.sampleShading->fboCoord.y, cycleStart);
+      }
+      getFragOutputs(quad.shaderProgram, fragColors[i]);
+    } else {
+      // broadcast shading result
+      for (int k = 0; k < fboColorCnt_; k++) {
+        fragColors[i][k] = fragColors[shaded][k];
+      }
+    }
 
     // per-sample operations
     if (pixel.sampleCount > 1) {
@@ -841,15 +1139,32 @@ void RendererSoft::rasterizationPixelQuad(PixelQuadContext &quad) {
         if (!sample.inside) {
           continue;
         }
-        processPerSampleOperations(sample.fboCoord.x, sample.fboCoord.y, sample.position.z, builtIn.FragColor, idx);
+        if (processPerSampleOperations<L>(sample.fboCoord.x, sample.fboCoord.y, sample.position.z, fragColors[i], idx)) {
+          quad.stats.samplesWritten++;
+        }
       }
     } else {
       auto &sample = *pixel.sampleShading;
-      processPerSampleOperations(sample.fboCoord.x, sample.fboCoord.y, sample.position.z, builtIn.FragColor, 0);
+      if (processPerSampleOperations<L>(sample.fboCoord.x, sample.fboCoord.y, sample.position.z, fragColors[i], 0)) {
+        quad.stats.samplesWritten++;
+      }
+    }
+  }
+}
+
+int RendererSoft::getQuadShadingRate(PixelQuadContext &quad) {
+  int rate = renderState_->shadingRate;
+  if (shadingRateImage_ && shadingRateTileSize_ > 0) {
+    auto &coord = quad.pixels[0].sampleShading->fboCoord;
+    uint8_t *tileRate = shadingRateImage_->get(coord.x / shadingRateTileSize_, coord.y / shadingRateTileSize_);
+    if (tileRate) {
+      rate |= (*tileRate & ShadingRate_2X2);
     }
   }
+  return rate;
 }
 
+template<typename L>
 bool RendererSoft::earlyZTest(PixelQuadContext &quad) {
   for (auto &pixel : quad.pixels) {
     if (!pixel.inside) {
@@ -862,7 +1177,7 @@ bool RendererSoft::earlyZTest(PixelQuadContext &quad) {
         if (!sample.inside) {
           continue;
         }
-        sample.inside = processDepthTest(sample.fboCoord.x, sample.fboCoord.y, sample.position.z, idx, true);
+        sample.inside = processDepthTest<L>(sample.fboCoord.x, sample.fboCoord.y, sample.position.z, idx, true);
         if (sample.inside) {
           inside = true;
         }
@@ -870,65 +1185,203 @@ bool RendererSoft::earlyZTest(PixelQuadContext &quad) {
       pixel.inside = inside;
     } else {
       auto &sample = *pixel.sampleShading;
-      sample.inside = processDepthTest(sample.fboCoord.x, sample.fboCoord.y, sample.position.z, 0, true);
+      sample.inside = processDepthTest<L>(sample.fboCoord.x, sample.fboCoord.y, sample.position.z, 0, true);
       pixel.inside = sample.inside;
     }
   }
   return quad.CheckInside();
 }
 
-void RendererSoft::multiSampleResolve() {
-  if (!fboColor_->buffer) {
-    fboColor_->buffer = Buffer<RGBA>::makeDefault(fboColor_->width, fboColor_->height);
+template<typename T>
+void RendererSoft::multiSampleResolve(ImageBufferSoft<T> &colorBuffer) {
+  auto &msBuffer = *colorBuffer.bufferMs4x;
+  if (!colorBuffer.buffer) {
+    colorBuffer.buffer = Buffer<T>::makeLayout(colorBuffer.width, colorBuffer.height, msBuffer.getLayout());
   }
 
-  auto *srcPtr = fboColor_->bufferMs4x->getRawDataPtr();
-  auto *dstPtr = fboColor_->buffer->getRawDataPtr();
+  // same size & layout, pixel index is shared
+  auto *srcPtr = msBuffer.getRawDataPtr();
+  auto *dstPtr = colorBuffer.buffer->getRawDataPtr();
+  int sampleCnt = colorBuffer.sampleCnt;
 
-  for (size_t row = 0; row < fboColor_->height; row++) {
-    auto *rowSrc = srcPtr + row * fboColor_->width;
-    auto *rowDst = dstPtr + row * fboColor_->width;
-#ifdef RASTER_MULTI_THREAD
-    threadPool_.pushTask([&, rowSrc, rowDst](int thread_id) {
-#endif
-      auto *src = rowSrc;
-      auto *dst = rowDst;
-      for (size_t idx = 0; idx < fboColor_->width; idx++) {
+  // resolve only inside render area
+  auto resolveRows = [&](size_t rowBegin, size_t rowEnd, size_t threadId) {
+    for (size_t row = rowBegin; row < rowEnd; row++) {
+      for (size_t x = renderArea_.x; x < renderArea_.x + renderArea_.width; x++) {
+        size_t idx = msBuffer.convertIndex(x, row);
         glm::vec4 color(0.f);
-        for (int i = 0; i < fboColor_->sampleCnt; i++) {
-          color += (glm::vec4) (*src)[i];
+        for (int i = 0; i < sampleCnt; i++) {
+          color += (glm::vec4) srcPtr[idx][i];
         }
-        color /= fboColor_->sampleCnt;
-        *dst = color;
-        src++;
-        dst++;
+        color /= sampleCnt;
+        dstPtr[idx] = T(color);
       }
+    }
+  };
+
+  size_t rowBegin = renderArea_.y;
+  size_t rowEnd = renderArea_.y + renderArea_.height;
 #ifdef RASTER_MULTI_THREAD
-    });
+  threadPool_.parallelFor(rowBegin, rowEnd, 0, resolveRows, rasterTasks_.getPriority());
+#else
+  resolveRows(rowBegin, rowEnd, 0);
 #endif
+}
+
+template<typename T>
+static inline bool setupColorBuffer(ColorBufferSoft &out, const std::shared_ptr<ImageBufferSoft<T>> &buffer) {
+  if (!buffer) {
+    return false;
+  }
+  out.width = buffer->width;
+  out.height = buffer->height;
+  out.sampleCnt = buffer->sampleCnt;
+  out.multiSample = buffer->multiSample;
+  out.layout = buffer->layout;
+  return true;
+}
+
+void RendererSoft::updateColorBuffers() {
+  fboColorCnt_ = 0;
+  for (int i = 0; i < fbo_->getColorAttachmentCount(); i++) {
+    auto &attachment = fbo_->getColorAttachment(i);
+    if (!fbo_->isColorReady() || !attachment.tex) {
+      break;
+    }
+
+    ColorBufferSoft colorBuffer;
+    colorBuffer.format = attachment.tex->format;
+    bool valid = false;
+    switch (colorBuffer.format) {
+      case TextureFormat_RGBA8:
+        colorBuffer.rgba8 = fbo_->getColorBuffer<RGBA>(i);
+        valid = setupColorBuffer(colorBuffer, colorBuffer.rgba8);
+        break;
+      case TextureFormat_RGBA16F:
+        colorBuffer.rgba16f = fbo_->getColorBuffer<RGBA16F>(i);
+        valid = setupColorBuffer(colorBuffer, colorBuffer.rgba16f);
+        break;
+      case TextureFormat_RGBA32F:
+        colorBuffer.rgba32f = fbo_->getColorBuffer<RGBA32F>(i);
+        valid = setupColorBuffer(colorBuffer, colorBuffer.rgba32f);
+        break;
+      default:
+        break;
+    }
+    if (!valid) {
+      LOGE("color attachment %d format not support", i);
+      break;
+    }
+
+    // all attachments should share size & sample count with attachment 0
+    if (i > 0 && (colorBuffer.width != fboColors_[0].width || colorBuffer.height != fboColors_[0].height
+        || colorBuffer.sampleCnt != fboColors_[0].sampleCnt)) {
+      LOGE("color attachment %d size or sample count mismatch, ignored", i);
+      break;
+    }
+    fboColors_[fboColorCnt_++] = colorBuffer;
+  }
+  for (int i = fboColorCnt_; i < MAX_COLOR_ATTACHMENTS; i++) {
+    fboColors_[i] = ColorBufferSoft();
   }
+}
 
-  threadPool_.waitTasksFinish();
+void RendererSoft::updateFboLayout() {
+  fboLayoutUniform_ = true;
+  fboLayout_ = fboColorCnt_ > 0 ? fboColors_[0].layout : (fboDepth_ ? fboDepth_->layout : Layout_Linear);
+  for (int i = 1; i < fboColorCnt_; i++) {
+    if (fboColors_[i].layout != fboLayout_) {
+      fboLayoutUniform_ = false;
+    }
+  }
+  if (fboDepth_ && fboDepth_->layout != fboLayout_) {
+    fboLayoutUniform_ = false;
+  }
 }
 
-RGBA *RendererSoft::getFrameColor(int x, int y, int sample) {
-  if (!fboColor_) {
-    return nullptr;
+void RendererSoft::clearColorBuffer(ColorBufferSoft &colorBuffer, const glm::vec4 &color) {
+  switch (colorBuffer.format) {
+    case TextureFormat_RGBA8: {
+      RGBA value = RGBA(color.r * 255, color.g * 255, color.b * 255, color.a * 255);
+      auto &buffer = colorBuffer.rgba8;
+      if (buffer->multiSample) {
+        clearBufferRect(*buffer->bufferMs4x, glm::tvec4<RGBA>(value));
+      } else {
+        clearBufferRect(*buffer->buffer, value);
+      }
+      break;
+    }
+    case TextureFormat_RGBA16F: {
+      RGBA16F value = RGBA16F(color);
+      auto &buffer = colorBuffer.rgba16f;
+      if (buffer->multiSample) {
+        clearBufferRect(*buffer->bufferMs4x, glm::tvec4<RGBA16F>(value));
+      } else {
+        clearBufferRect(*buffer->buffer, value);
+      }
+      break;
+    }
+    case TextureFormat_RGBA32F: {
+      auto &buffer = colorBuffer.rgba32f;
+      if (buffer->multiSample) {
+        clearBufferRect(*buffer->bufferMs4x, glm::tvec4<RGBA32F>(color));
+      } else {
+        clearBufferRect(*buffer->buffer, color);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+// large render area is cleared in row bands on pool workers
+template<typename T>
+void RendererSoft::clearBufferRect(Buffer<T> &buffer, const T &value) {
+  auto &area = renderArea_;
+  if ((size_t) area.width * area.height < CLEAR_PARALLEL_MIN_PIXELS) {
+    buffer.setRect(area.x, area.y, area.width, area.height, value);
+    return;
   }
+  threadPool_.parallelFor(area.y, area.y + area.height, CLEAR_PARALLEL_GRAIN_ROWS,
+                          [&](size_t begin, size_t end, size_t threadId) {
+                            buffer.setRect(area.x, begin, area.width, end - begin, value);
+                          }, rasterTasks_.getPriority());
+}
 
-  RGBA *ptr = nullptr;
-  if (fboColor_->multiSample) {
-    auto *ptrMs = fboColor_->bufferMs4x->get(x, y);
+void RendererSoft::getFragOutputs(ShaderProgramSoft *shader, glm::vec4 *outputs) {
+  auto &builtin = shader->getShaderBuiltin();
+  if (fragDataCnt_ > 0) {
+    for (int i = 0; i < fragDataCnt_; i++) {
+      outputs[i] = builtin.FragData[i];
+    }
+    // attachments without shader output keep undefined value as GL, write zero here
+    for (int i = fragDataCnt_; i < fboColorCnt_; i++) {
+      outputs[i] = glm::vec4(0.f);
+    }
+  } else {
+    for (int i = 0; i < fboColorCnt_; i++) {
+      outputs[i] = builtin.FragColor;
+    }
+  }
+}
+
+template<typename L, typename T>
+T *RendererSoft::getFrameColor(ImageBufferSoft<T> &colorBuffer, int x, int y, int sample) {
+  T *ptr = nullptr;
+  if (colorBuffer.multiSample) {
+    auto *ptrMs = colorBuffer.bufferMs4x->template get<L>(x, y);
     if (ptrMs) {
-      ptr = (RGBA *) ptrMs + sample;
+      ptr = (T *) ptrMs + sample;
     }
   } else {
-    ptr = fboColor_->buffer->get(x, y);
+    ptr = colorBuffer.buffer->template get<L>(x, y);
   }
 
   return ptr;
 }
 
+template<typename L>
 float *RendererSoft::getFrameDepth(int x, int y, int sample) {
   if (!fboDepth_) {
     return nullptr;
@@ -936,26 +1389,18 @@ float *RendererSoft::getFrameDepth(int x, int y, int sample) {
 
   float *depthPtr = nullptr;
   if (fboDepth_->multiSample) {
-    auto *ptr = fboDepth_->bufferMs4x->get(x, y);
+    auto *ptr = fboDepth_->bufferMs4x->template get<L>(x, y);
     if (ptr) {
       depthPtr = &ptr->x + sample;
     }
   } else {
-    depthPtr = fboDepth_->buffer->get(x, y);
+    depthPtr = fboDepth_->buffer->template get<L>(x, y);
   }
   return depthPtr;
 }
 
-void RendererSoft::setFrameColor(int x, int y, const RGBA &color, int sample) {
-  RGBA *ptr = getFrameColor(x, y, sample);
-  if (ptr) {
-    *ptr = color;
-  }
-}
-
 size_t RendererSoft::clippingNewVertex(size_t idx0, size_t idx1, float t, bool postVertexProcess) {
-  vertexes_.emplace_back();
-  VertexHolder &vh = vertexes_.back();
+  VertexHolder &vh = vertexes_.emplace_back();
   vh.discard = false;
   vh.index = vertexes_.size() - 1;
   interpolateVertex(vh, vertexes_[idx0], vertexes_[idx1], t);
@@ -969,12 +1414,17 @@ size_t RendererSoft::clippingNewVertex(size_t idx0, size_t idx1, float t, bool p
 }
 
 void RendererSoft::vertexShaderImpl(VertexHolder &vertex) {
-  shaderProgram_->bindVertexAttributes(vertex.vertex);
-  shaderProgram_->bindVertexShaderVaryings(vertex.varyings);
-  shaderProgram_->execVertexShader();
-
+  drawStats_.vertexShaderInvocations++;
+  vertexShaderExec(vertex, shaderProgram_);
   pointSize_ = shaderProgram_->getShaderBuiltin().PointSize;
-  vertex.clipPos = shaderProgram_->getShaderBuiltin().Position;
+}
+
+void RendererSoft::vertexShaderExec(VertexHolder &vertex, ShaderProgramSoft *program) {
+  program->bindVertexAttributes(vertex.vertex);
+  program->bindVertexShaderVaryings(vertex.varyings);
+  program->execVertexShader();
+
+  vertex.clipPos = program->getShaderBuiltin().Position;
   vertex.clipMask = countFrustumClipMask(vertex.clipPos);
 }
 
@@ -1002,16 +1452,16 @@ int RendererSoft::countFrustumClipMask(glm::vec4 &clipPos) {
   return mask;
 }
 
-BoundingBox RendererSoft::triangleBoundingBox(glm::vec4 *vert, float width, float height) {
+BoundingBox RendererSoft::triangleBoundingBox(glm::vec4 *vert, const Rect2D &rect) {
   float minX = std::min(std::min(vert[0].x, vert[1].x), vert[2].x);
   float minY = std::min(std::min(vert[0].y, vert[1].y), vert[2].y);
   float maxX = std::max(std::max(vert[0].x, vert[1].x), vert[2].x);
   float maxY = std::max(std::max(vert[0].y, vert[1].y), vert[2].y);
 
-  minX = std::max(minX - 0.5f, 0.f);
-  minY = std::max(minY - 0.5f, 0.f);
-  maxX = std::min(maxX + 0.5f, width - 1.f);
-  maxY = std::min(maxY + 0.5f, height - 1.f);
+  minX = std::max(minX - 0.5f, (float) rect.x);
+  minY = std::max(minY - 0.5f, (float) rect.y);
+  maxX = std::min(maxX + 0.5f, (float) (rect.x + rect.width - 1));
+  maxY = std::min(maxY + 0.5f, (float) (rect.y + rect.height - 1));
 
   auto min = glm::vec3(minX, minY, 0.f);
   auto max = glm::vec3(maxX, maxY, 0.f);
@@ -1056,10 +1506,8 @@ bool RendererSoft::barycentric(glm::aligned_vec4 *vert, glm::aligned_vec4 &v0, g
 }
 
 void RendererSoft::interpolateVertex(VertexHolder &out, VertexHolder &v0, VertexHolder &v1, float t) {
-  out.vertexHolder = MemoryUtils::makeBuffer<uint8_t>(vao_->vertexStride);
-  out.vertex = out.vertexHolder.get();
-  out.varyingsHolder = MemoryUtils::makeAlignedBuffer<float>(varyingsAlignedCnt_);
-  out.varyings = out.varyingsHolder.get();
+  out.vertex = drawArena_.allocArray<uint8_t>(vao_->vertexStride);
+  out.varyings = drawArena_.allocArray<float>(varyingsAlignedCnt_);
 
   // interpolate vertex (only support float element right now)
   const float *vertexIn[2] = {(float *) v0.vertex, (float *) v1.vertex};
@@ -12,11 +12,40 @@
 #include "Render/Renderer.h"
 #include "Render/Software/VertexSoft.h"
 #include "Render/Software/FramebufferSoft.h"
+#include "Render/Software/QuerySoft.h"
 
 namespace SoftGL {
 
+enum ShadingCostMode {
+  ShadingCost_NONE,
+  ShadingCost_INVOCATIONS,    // fragment shader invocations per pixel (overdraw)
+  ShadingCost_CYCLES,         // cpu cycles spent in fragment shader per pixel
+};
+
+// color attachment of any color format, only buffer matching format is valid
+struct ColorBufferSoft {
+  TextureFormat format = TextureFormat_RGBA8;
+  int width = 0;
+  int height = 0;
+  int sampleCnt = 1;
+  bool multiSample = false;
+  BufferLayout layout = Layout_Linear;
+
+  std::shared_ptr<ImageBufferSoft<RGBA>> rgba8 = nullptr;
+  std::shared_ptr<ImageBufferSoft<RGBA16F>> rgba16f = nullptr;
+  std::shared_ptr<ImageBufferSoft<RGBA32F>> rgba32f = nullptr;
+};
+
 class RendererSoft : public Renderer {
  public:
+  // all instances share process-wide thread pool, priority among its other submitters
+  explicit RendererSoft(TaskPriority priority = TaskPriority_NORMAL)
+      : threadPool_(ThreadPool::shared()), rasterTasks_(priority) {}
+
+  inline void setTaskPriority(TaskPriority priority) {
+    rasterTasks_.setPriority(priority);
+  }
+
   RendererType type() override { return Renderer_SOFT; }
 
   // framebuffer
@@ -39,7 +68,8 @@ class RendererSoft : public Renderer {
   std::shared_ptr<UniformSampler> createUniformSampler(const std::string &name, const TextureDesc &desc) override;
 
   // pipeline
-  void beginRenderPass(std::shared_ptr<FrameBuffer> &frameBuffer, const ClearStates &states) override;
+  void beginRenderPass(std::shared_ptr<FrameBuffer> &frameBuffer, const ClearStates &states,
+                       const Rect2D &renderArea = {}) override;
   void setViewPort(int x, int y, int width, int height) override;
   void setVertexArrayObject(std::shared_ptr<VertexArrayObject> &vao) override;
   void setShaderProgram(std::shared_ptr<ShaderProgram> &program) override;
@@ -49,8 +79,28 @@ class RendererSoft : public Renderer {
   void endRenderPass() override;
   void waitIdle() override;
 
+  // statistics
+  void resetFrameStatistics() override;
+  const PipelineStatistics *getDrawStatistics() override;
+  const PipelineStatistics *getFrameStatistics() override;
+
+  // occlusion query
+  std::shared_ptr<QueryObject> createQuery() override;
+  void beginQuery(std::shared_ptr<QueryObject> &query) override;
+  void endQuery(std::shared_ptr<QueryObject> &query) override;
+  bool getQueryResult(std::shared_ptr<QueryObject> &query, uint64_t &samples) override;
+  void beginConditionalRender(std::shared_ptr<QueryObject> &query) override;
+  void endConditionalRender() override;
+
  public:
   inline void setEnableEarlyZ(bool enable) { earlyZ_ = enable; };
+  inline void setShadingCostMode(ShadingCostMode mode) { shadingCostMode_ = mode; };
+
+  // per screen tile shading rate (ShadingRate per texel), combined with per draw rate by max
+  inline void setShadingRateImage(const std::shared_ptr<Buffer<uint8_t>> &image, int tileSize) {
+    shadingRateImage_ = image;
+    shadingRateTileSize_ = tileSize;
+  };
 
  private:
   void processVertexShader();
@@ -61,9 +111,13 @@ class RendererSoft : public Renderer {
   void processFaceCulling();
   void processRasterization();
   void processFragmentShader(glm::vec4 &screenPos, bool frontFacing, void *varyings, ShaderProgramSoft *shader);
-  void processPerSampleOperations(int x, int y, float depth, const glm::vec4 &color, int sample);
+  template<typename L = AnyIndex>
+  bool processPerSampleOperations(int x, int y, float depth, const glm::vec4 *colors, int sample);
+  template<typename L = AnyIndex>
   bool processDepthTest(int x, int y, float depth, int sample, bool skipWrite);
-  void processColorBlending(int x, int y, glm::vec4 &color, int sample);
+  template<typename L, typename T>
+  void processColorWrite(ImageBufferSoft<T> &colorBuffer, int x, int y, glm::vec4 color, int sample);
+  void processShadingCost(int x, int y, uint64_t cycleStart);
 
   void processPointAssembly();
   void processLineAssembly();
@@ -71,7 +125,7 @@ class RendererSoft : public Renderer {
 
   void clippingPoint(PrimitiveHolder &point);
   void clippingLine(PrimitiveHolder &line, bool postVertexProcess = false);
-  void clippingTriangle(PrimitiveHolder &triangle, std::vector<PrimitiveHolder> &appendPrimitives);
+  void clippingTriangle(size_t triangleIdx);
 
   void interpolateVertex(VertexHolder &out, VertexHolder &v0, VertexHolder &v1, float t);
   void interpolateLinear(float *varsOut, const float *varsIn[2], size_t elemCnt, float t);
@@ -81,43 +135,66 @@ class RendererSoft : public Renderer {
   void rasterizationPoint(VertexHolder *v, float pointSize);
   void rasterizationLine(VertexHolder *v0, VertexHolder *v1, float lineWidth);
   void rasterizationTriangle(VertexHolder *v0, VertexHolder *v1, VertexHolder *v2, bool frontFacing);
-  void rasterizationPolygons(std::vector<PrimitiveHolder> &primitives);
-  void rasterizationPolygonsPoint(std::vector<PrimitiveHolder> &primitives);
-  void rasterizationPolygonsLine(std::vector<PrimitiveHolder> &primitives);
-  void rasterizationPolygonsTriangle(std::vector<PrimitiveHolder> &primitives);
+  void rasterizationPolygons(ArenaVector<PrimitiveHolder> &primitives);
+  void rasterizationPolygonsPoint(ArenaVector<PrimitiveHolder> &primitives);
+  void rasterizationPolygonsLine(ArenaVector<PrimitiveHolder> &primitives);
+  void rasterizationPolygonsTriangle(ArenaVector<PrimitiveHolder> &primitives);
+  template<typename L>
+  void rasterizationBlock(PixelQuadContext &quad, int blockStartX, int blockStartY, int blockSize,
+                          const BoundingBox &bounds);
+  template<typename L>
   void rasterizationPixelQuad(PixelQuadContext &quad);
 
+  template<typename L>
   bool earlyZTest(PixelQuadContext &quad);
-  void multiSampleResolve();
+  int getQuadShadingRate(PixelQuadContext &quad);
+  template<typename T>
+  void multiSampleResolve(ImageBufferSoft<T> &colorBuffer);
  private:
-  inline RGBA *getFrameColor(int x, int y, int sample);
+  void updateColorBuffers();
+  void updateFboLayout();
+  void clearColorBuffer(ColorBufferSoft &colorBuffer, const glm::vec4 &color);
+  template<typename T>
+  void clearBufferRect(Buffer<T> &buffer, const T &value);
+  inline void getFragOutputs(ShaderProgramSoft *shader, glm::vec4 *outputs);
+  template<typename L, typename T>
+  inline T *getFrameColor(ImageBufferSoft<T> &colorBuffer, int x, int y, int sample);
+  template<typename L>
   inline float *getFrameDepth(int x, int y, int sample);
-  inline void setFrameColor(int x, int y, const RGBA &color, int sample);
 
   size_t clippingNewVertex(size_t idx0, size_t idx1, float t, bool postVertexProcess = false);
   void vertexShaderImpl(VertexHolder &vertex);
+  void vertexShaderExec(VertexHolder &vertex, ShaderProgramSoft *program);
   void perspectiveDivideImpl(VertexHolder &vertex);
   void viewportTransformImpl(VertexHolder &vertex);
   int countFrustumClipMask(glm::vec4 &clipPos);
-  BoundingBox triangleBoundingBox(glm::vec4 *vert, float width, float height);
+  BoundingBox triangleBoundingBox(glm::vec4 *vert, const Rect2D &rect);
 
   bool barycentric(glm::aligned_vec4 *vert, glm::aligned_vec4 &v0, glm::aligned_vec4 &p, glm::aligned_vec4 &bc);
 
  private:
   Viewport viewport_{};
+  Rect2D renderArea_{};   // render pass area, clamped to framebuffer
+  Rect2D rasterRect_{};   // per draw: render area & viewport & scissor
   PrimitiveType primitiveType_ = Primitive_TRIANGLE;
   FrameBufferSoft *fbo_ = nullptr;
   const RenderStates *renderState_ = nullptr;
   VertexArrayObjectSoft *vao_ = nullptr;
   ShaderProgramSoft *shaderProgram_ = nullptr;
 
-  std::shared_ptr<ImageBufferSoft<RGBA>> fboColor_ = nullptr;
+  ColorBufferSoft fboColors_[MAX_COLOR_ATTACHMENTS];
+  int fboColorCnt_ = 0;
+  int fragDataCnt_ = 0;
   std::shared_ptr<ImageBufferSoft<float>> fboDepth_ = nullptr;
+  std::shared_ptr<ImageBufferSoft<float>> fboCost_ = nullptr;
+  bool fboLayoutUniform_ = true;  // all color & depth attachments share fboLayout_
+  BufferLayout fboLayout_ = Layout_Linear;
 
-  std::vector<VertexHolder> vertexes_;
-  std::vector<PrimitiveHolder> primitives_;
+  // per draw scratch, reset at draw begin
+  LinearArena drawArena_;
+  ArenaVector<VertexHolder> vertexes_;
+  ArenaVector<PrimitiveHolder> primitives_;
 
-  std::shared_ptr<float> varyings_ = nullptr;
   size_t varyingsCnt_ = 0;
   size_t varyingsAlignedCnt_ = 0;
   size_t varyingsAlignedSize_ = 0;
@@ -126,9 +203,21 @@ class RendererSoft : public Renderer {
   bool earlyZ_ = true;
   int rasterSamples_ = 1;
   int rasterBlockSize_ = 32;
+  ShadingCostMode shadingCostMode_ = ShadingCost_NONE;
 
-  ThreadPool threadPool_;
+  std::shared_ptr<Buffer<uint8_t>> shadingRateImage_ = nullptr;
+  int shadingRateTileSize_ = 16;
+
+  ThreadPool &threadPool_;
+  TaskGroup rasterTasks_;
   std::vector<PixelQuadContext> threadQuadCtx_;
+  std::vector<LinearArena> threadArenas_;   // per thread scratch, reset at endRenderPass
+
+  PipelineStatistics drawStats_;
+  PipelineStatistics frameStats_;
+
+  QueryObjectSoft *activeQuery_ = nullptr;
+  QueryObjectSoft *conditionQuery_ = nullptr;
 };
 
 }
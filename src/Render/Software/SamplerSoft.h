@@ -6,79 +6,149 @@
 
 #pragma once
 
-#include <functional>
 #include "TextureSoft.h"
+#include "MipmapSoft.h"
+
+#ifdef SOFTGL_SIMD_OPT
+#include <emmintrin.h>
+#endif
 
 namespace SoftGL {
 
-#define CoordMod(i, n) ((i) & ((n) - 1) + (n)) & ((n) - 1)  // (i % n + n) % n
-#define CoordMirror(i) (i) >= 0 ? (i) : (-1 - (i))
+// wrap policies: wrap one texel coordinate into [0, n), return false if outside with clamp to border.
+// power of two sizes wrap with a mask, other sizes with modulo
+struct WrapRepeatPOT {
+  static inline bool wrap(int &i, int n) {
+    i &= n - 1;
+    return true;
+  }
+};
+
+// most taps are inside, skip the division for them
+struct WrapRepeat {
+  static inline bool wrap(int &i, int n) {
+    if ((unsigned) i >= (unsigned) n) {
+      i %= n;
+      if (i < 0) i += n;
+    }
+    return true;
+  }
+};
+
+// period 2n: [0, n) as is, [n, 2n) reversed
+struct WrapMirrorPOT {
+  static inline bool wrap(int &i, int n) {
+    i &= 2 * n - 1;
+    if (i >= n) i = 2 * n - 1 - i;
+    return true;
+  }
+};
+
+struct WrapMirror {
+  static inline bool wrap(int &i, int n) {
+    if ((unsigned) i >= (unsigned) n) {
+      i %= 2 * n;
+      if (i < 0) i += 2 * n;
+      if (i >= n) i = 2 * n - 1 - i;
+    }
+    return true;
+  }
+};
 
+struct WrapClampEdge {
+  static inline bool wrap(int &i, int n) {
+    i = glm::clamp(i, 0, n - 1);
+    return true;
+  }
+};
+
+struct WrapClampBorder {
+  static inline bool wrap(int &i, int n) {
+    return i >= 0 && i < n;
+  }
+};
+
+// T: texel storage type, S: sampled (filtering) type, see TexelTraits
 template<typename T>
 class BaseSampler {
  public:
+  using S = typename TexelTraits<T>::Sample;
+
   virtual bool empty() = 0;
   inline size_t width() const { return width_; }
   inline size_t height() const { return height_; }
-  inline T &borderColor() { return borderColor_; };
+  inline S &borderColor() { return borderColor_; };
+  inline bool useMipmaps() const { return useMipmaps_; }
 
-  T textureImpl(TextureImageSoft<T> *tex, glm::vec2 &uv, float lod = 0.f, glm::ivec2 offset = glm::ivec2(0));
-  static T sampleNearest(Buffer<T> *buffer, glm::vec2 &uv, WrapMode wrap, glm::ivec2 &offset, T border);
-  static T sampleBilinear(Buffer<T> *buffer, glm::vec2 &uv, WrapMode wrap, glm::ivec2 &offset, T border);
+  S textureImpl(TextureImageSoft<T> *tex, glm::vec2 uv, float lod = 0.f, glm::ivec2 offset = glm::ivec2(0));
 
-  static T pixelWithWrapMode(Buffer<T> *buffer, int x, int y, WrapMode wrap, T border);
-  static void sampleBufferBilinear(Buffer<T> *buffer_out, Buffer<T> *buffer_in, T border);
-  static T samplePixelBilinear(Buffer<T> *buffer, glm::vec2 uv, WrapMode wrap, T border);
+  // L: buffer layout index (see Buffer.h), all mip levels share the layout of level 0
+  // W: wrap policy, power of two variants require all levels to be power of two
+  template<typename L, typename W>
+  S textureLayoutImpl(TextureImageSoft<T> *tex, glm::vec2 uv, float lod, glm::ivec2 offset);
+  template<typename L, typename W>
+  static S sampleNearest(Buffer<T> *buffer, glm::vec2 uv, glm::ivec2 offset, S border);
+  template<typename L, typename W>
+  static S sampleBilinear(Buffer<T> *buffer, glm::vec2 uv, glm::ivec2 offset, S border);
+
+  template<typename L, typename W>
+  static S pixelWithWrapMode(Buffer<T> *buffer, int x, int y, S border);
+  template<typename L, typename W>
+  static S samplePixelBilinear(Buffer<T> *buffer, glm::vec2 uv, S border);
 
   inline void setWrapMode(int wrap_mode) {
     wrapMode_ = (WrapMode) wrap_mode;
+    updateSampleFunc();
   }
 
   inline void setFilterMode(int filter_mode) {
     filterMode_ = (FilterMode) filter_mode;
   }
 
-  inline void setLodFunc(std::function<float(BaseSampler<T> *)> *func) {
-    lodFunc_ = func;
-  }
-
   static void generateMipmaps(TextureImageSoft<T> *tex, bool sample);
 
  protected:
-  T borderColor_;
+  void updateImage(TextureImageSoft<T> *tex);
+  void updateSampleFunc();
+  template<typename L>
+  void updateSampleFunc();
+
+  S borderColor_;
 
   size_t width_ = 0;
   size_t height_ = 0;
 
-  bool useMipmaps = false;
+  bool useMipmaps_ = false;
   WrapMode wrapMode_ = Wrap_CLAMP_TO_EDGE;
   FilterMode filterMode_ = Filter_LINEAR;
-  std::function<float(BaseSampler<T> *)> *lodFunc_ = nullptr;
+
+  // specialized on (layout, wrap mode, power of two) of current image
+  typedef S (BaseSampler<T>::*SampleFunc)(TextureImageSoft<T> *, glm::vec2, float, glm::ivec2);
+  BufferLayout layout_ = Layout_Linear;
+  bool pot_ = false;
+  SampleFunc sampleFunc_ = &BaseSampler<T>::template textureLayoutImpl<LinearIndex, WrapClampEdge>;
 };
 
 template<typename T>
 class BaseSampler2D : public BaseSampler<T> {
  public:
+  using S = typename BaseSampler<T>::S;
+
   inline void setImage(TextureImageSoft<T> *tex) {
     tex_ = tex;
-    BaseSampler<T>::width_ = (tex_ == nullptr) ? 0 : tex_->getWidth();
-    BaseSampler<T>::height_ = (tex_ == nullptr) ? 0 : tex_->getHeight();
-    BaseSampler<T>::useMipmaps = BaseSampler<T>::filterMode_ > Filter_LINEAR;
+    BaseSampler<T>::updateImage(tex);
   }
 
   inline bool empty() override {
     return tex_ == nullptr;
   }
 
-  T texture2DImpl(glm::vec2 &uv, float bias = 0.f) {
-    float lod = bias;
-    if (BaseSampler<T>::useMipmaps && BaseSampler<T>::lodFunc_) {
-      lod += (*BaseSampler<T>::lodFunc_)(this);
-    }
-    return texture2DLodImpl(uv, lod);
+  // derivative lod is computed by shader (see ShaderSoft::getSampler2DLod)
+  S texture2DImpl(glm::vec2 uv, float bias = 0.f) {
+    return texture2DLodImpl(uv, bias);
   }
 
-  T texture2DLodImpl(glm::vec2 &uv, float lod = 0.f, glm::ivec2 offset = glm::ivec2(0)) {
+  S texture2DLodImpl(glm::vec2 uv, float lod = 0.f, glm::ivec2 offset = glm::ivec2(0)) {
     return BaseSampler<T>::textureImpl(tex_, uv, lod, offset);
   }
 
@@ -97,15 +167,37 @@ void BaseSampler<T>::generateMipmaps(TextureImageSoft<T> *tex, bool sample) {
 
   uint32_t levelCount = static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
   for (uint32_t level = 1; level < levelCount; level++) {
-    tex->levels.push_back(std::make_shared<ImageBufferSoft<T>>(std::max(1, width >> level), std::max(1, height >> level)));
+    tex->levels.push_back(std::make_shared<ImageBufferSoft<T>>(std::max(1, width >> level), std::max(1, height >> level),
+                                                               1, level0->buffer ? level0->buffer->getLayout() : Layout_Linear));
   }
 
-  if (!sample) {
+  if (!sample || !level0->buffer) {
     return;
   }
 
-  for (int i = 1; i < tex->levels.size(); i++) {
-    BaseSampler<T>::sampleBufferBilinear(tex->levels[i]->buffer.get(), tex->levels[i - 1]->buffer.get(), T(0));
+  // downsample on row major images, tiled & morton levels go through linear scratch
+  bool linear = level0->buffer->getLayout() == Layout_Linear;
+  std::vector<T> scratch[2];
+  const T *src = level0->buffer->getRawDataPtr();
+  if (!linear) {
+    scratch[0].resize((size_t) width * height);
+    level0->buffer->copyLinearDataTo(scratch[0].data());
+    src = scratch[0].data();
+  }
+
+  for (size_t i = 1; i < tex->levels.size(); i++) {
+    auto &prev = *tex->levels[i - 1];
+    auto &level = *tex->levels[i];
+    T *dst = level.buffer->getRawDataPtr();
+    if (!linear) {
+      scratch[i & 1].resize((size_t) level.width * level.height);
+      dst = scratch[i & 1].data();
+    }
+    MipmapSoft::downsample(src, prev.width, prev.height, dst, level.width, level.height);
+    if (!linear) {
+      level.buffer->copyLinearDataFrom(dst);
+    }
+    src = dst;
   }
 }
 
@@ -115,159 +207,255 @@ void TextureImageSoft<T>::generateMipmap(bool sample) {
 }
 
 template<typename T>
-T BaseSampler<T>::textureImpl(TextureImageSoft<T> *tex,
-                              glm::vec2 &uv,
+void BaseSampler<T>::updateImage(TextureImageSoft<T> *tex) {
+  width_ = (tex == nullptr) ? 0 : tex->getWidth();
+  height_ = (tex == nullptr) ? 0 : tex->getHeight();
+  useMipmaps_ = filterMode_ > Filter_LINEAR;
+  if (tex != nullptr && !tex->empty() && tex->levels[0]->buffer) {
+    layout_ = tex->levels[0]->buffer->getLayout();
+  }
+  // mip level sizes are max(1, size >> level), power of two if level 0 is
+  pot_ = width_ > 0 && height_ > 0 && (width_ & (width_ - 1)) == 0 && (height_ & (height_ - 1)) == 0;
+  updateSampleFunc();
+}
+
+template<typename T>
+void BaseSampler<T>::updateSampleFunc() {
+  switch (layout_) {
+    case Layout_Tiled:
+      updateSampleFunc<TiledIndex>();
+      break;
+    case Layout_Morton:
+      updateSampleFunc<MortonIndex>();
+      break;
+    case Layout_Linear:
+    default:
+      updateSampleFunc<LinearIndex>();
+      break;
+  }
+}
+
+template<typename T>
+template<typename L>
+void BaseSampler<T>::updateSampleFunc() {
+  switch (wrapMode_) {
+    case Wrap_REPEAT:
+      sampleFunc_ = pot_ ? &BaseSampler<T>::template textureLayoutImpl<L, WrapRepeatPOT>
+                         : &BaseSampler<T>::template textureLayoutImpl<L, WrapRepeat>;
+      break;
+    case Wrap_MIRRORED_REPEAT:
+      sampleFunc_ = pot_ ? &BaseSampler<T>::template textureLayoutImpl<L, WrapMirrorPOT>
+                         : &BaseSampler<T>::template textureLayoutImpl<L, WrapMirror>;
+      break;
+    case Wrap_CLAMP_TO_BORDER:
+      sampleFunc_ = &BaseSampler<T>::template textureLayoutImpl<L, WrapClampBorder>;
+      break;
+    case Wrap_CLAMP_TO_EDGE:
+    default:
+      sampleFunc_ = &BaseSampler<T>::template textureLayoutImpl<L, WrapClampEdge>;
+      break;
+  }
+}
+
+template<typename T>
+typename BaseSampler<T>::S BaseSampler<T>::textureImpl(TextureImageSoft<T> *tex,
+                              glm::vec2 uv,
                               float lod,
                               glm::ivec2 offset) {
   if (tex != nullptr && !tex->empty()) {
-    if (filterMode_ == Filter_NEAREST) {
-      return sampleNearest(tex->levels[0]->buffer.get(), uv, wrapMode_, offset, borderColor_);
-    }
-    if (filterMode_ == Filter_LINEAR) {
-      return sampleBilinear(tex->levels[0]->buffer.get(), uv, wrapMode_, offset, borderColor_);
+    return (this->*sampleFunc_)(tex, uv, lod, offset);
+  }
+  return S(0);
+}
+
+template<typename T>
+template<typename L, typename W>
+typename BaseSampler<T>::S BaseSampler<T>::textureLayoutImpl(TextureImageSoft<T> *tex,
+                                                             glm::vec2 uv,
+                                                             float lod,
+                                                             glm::ivec2 offset) {
+  if (filterMode_ == Filter_NEAREST) {
+    return sampleNearest<L, W>(tex->levels[0]->buffer.get(), uv, offset, borderColor_);
+  }
+  if (filterMode_ == Filter_LINEAR) {
+    return sampleBilinear<L, W>(tex->levels[0]->buffer.get(), uv, offset, borderColor_);
+  }
+
+  // mipmaps
+  int max_level = (int) tex->levels.size() - 1;
+
+  if (filterMode_ == Filter_NEAREST_MIPMAP_NEAREST || filterMode_ == Filter_LINEAR_MIPMAP_NEAREST) {
+    int level = glm::clamp((int) glm::ceil(lod + 0.5f) - 1, 0, max_level);
+    if (filterMode_ == Filter_NEAREST_MIPMAP_NEAREST) {
+      return sampleNearest<L, W>(tex->levels[level]->buffer.get(), uv, offset, borderColor_);
+    } else {
+      return sampleBilinear<L, W>(tex->levels[level]->buffer.get(), uv, offset, borderColor_);
     }
+  }
 
-    // mipmaps
-    int max_level = (int) tex->levels.size() - 1;
+  if (filterMode_ == Filter_NEAREST_MIPMAP_LINEAR || filterMode_ == Filter_LINEAR_MIPMAP_LINEAR) {
+    int level_hi = glm::clamp((int) std::floor(lod), 0, max_level);
+    int level_lo = glm::clamp(level_hi + 1, 0, max_level);
 
-    if (filterMode_ == Filter_NEAREST_MIPMAP_NEAREST || filterMode_ == Filter_LINEAR_MIPMAP_NEAREST) {
-      int level = glm::clamp((int) glm::ceil(lod + 0.5f) - 1, 0, max_level);
-      if (filterMode_ == Filter_NEAREST_MIPMAP_NEAREST) {
-        return sampleNearest(tex->levels[level]->buffer.get(), uv, wrapMode_, offset, borderColor_);
-      } else {
-        return sampleBilinear(tex->levels[level]->buffer.get(), uv, wrapMode_, offset, borderColor_);
-      }
+    S texel_hi, texel_lo;
+    if (filterMode_ == Filter_NEAREST_MIPMAP_LINEAR) {
+      texel_hi = sampleNearest<L, W>(tex->levels[level_hi]->buffer.get(), uv, offset, borderColor_);
+    } else {
+      texel_hi = sampleBilinear<L, W>(tex->levels[level_hi]->buffer.get(), uv, offset, borderColor_);
     }
 
-    if (filterMode_ == Filter_NEAREST_MIPMAP_LINEAR || filterMode_ == Filter_LINEAR_MIPMAP_LINEAR) {
-      int level_hi = glm::clamp((int) std::floor(lod), 0, max_level);
-      int level_lo = glm::clamp(level_hi + 1, 0, max_level);
-
-      T texel_hi, texel_lo;
+    if (level_hi == level_lo) {
+      return texel_hi;
+    } else {
       if (filterMode_ == Filter_NEAREST_MIPMAP_LINEAR) {
-        texel_hi = sampleNearest(tex->levels[level_hi]->buffer.get(), uv, wrapMode_, offset, borderColor_);
+        texel_lo = sampleNearest<L, W>(tex->levels[level_lo]->buffer.get(), uv, offset, borderColor_);
       } else {
-        texel_hi = sampleBilinear(tex->levels[level_hi]->buffer.get(), uv, wrapMode_, offset, borderColor_);
+        texel_lo = sampleBilinear<L, W>(tex->levels[level_lo]->buffer.get(), uv, offset, borderColor_);
       }
-
-      if (level_hi == level_lo) {
-        return texel_hi;
-      } else {
-        if (filterMode_ == Filter_NEAREST_MIPMAP_LINEAR) {
-          texel_lo = sampleNearest(tex->levels[level_lo]->buffer.get(), uv, wrapMode_, offset, borderColor_);
-        } else {
-          texel_lo = sampleBilinear(tex->levels[level_lo]->buffer.get(), uv, wrapMode_, offset, borderColor_);
-        }
-      }
-
-      float f = glm::fract(lod);
-      return glm::mix(texel_hi, texel_lo, f);
     }
+
+    float f = glm::fract(lod);
+    return glm::mix(texel_hi, texel_lo, f);
   }
-  return T(0);
+  return S(0);
 }
 
 template<typename T>
-T BaseSampler<T>::pixelWithWrapMode(Buffer<T> *buffer, int x, int y, WrapMode wrap, T border) {
-  int w = (int) buffer->getWidth();
-  int h = (int) buffer->getHeight();
-  switch (wrap) {
-    case Wrap_REPEAT: {
-      x = CoordMod(x, w);
-      y = CoordMod(y, h);
-      break;
-    }
-    case Wrap_MIRRORED_REPEAT: {
-      x = CoordMod(x, 2 * w);
-      y = CoordMod(y, 2 * h);
-
-      x -= w;
-      y -= h;
-
-      x = CoordMirror(x);
-      y = CoordMirror(y);
-
-      x = w - 1 - x;
-      y = h - 1 - y;
-      break;
-    }
-    case Wrap_CLAMP_TO_EDGE: {
-      if (x < 0) x = 0;
-      if (y < 0) y = 0;
-      if (x >= w) x = w - 1;
-      if (y >= h) y = h - 1;
-      break;
-    }
-    case Wrap_CLAMP_TO_BORDER: {
-      if (x < 0 || x >= w) return border;
-      if (y < 0 || y >= h) return border;
-      break;
-    }
+template<typename L, typename W>
+typename BaseSampler<T>::S BaseSampler<T>::pixelWithWrapMode(Buffer<T> *buffer, int x, int y, S border) {
+  if (!W::wrap(x, (int) buffer->getWidth()) || !W::wrap(y, (int) buffer->getHeight())) {
+    return border;
   }
 
-  T *ptr = buffer->get(x, y);
+  T *ptr = buffer->template get<L>(x, y);
   if (ptr) {
-    return *ptr;
+    return TexelTraits<T>::load(*ptr);
   }
-  return T(0);
+  return S(0);
 }
 
 template<typename T>
-T BaseSampler<T>::sampleNearest(Buffer<T> *buffer,
-                                glm::vec2 &uv,
-                                WrapMode wrap,
-                                glm::ivec2 &offset,
-                                T border) {
+template<typename L, typename W>
+typename BaseSampler<T>::S BaseSampler<T>::sampleNearest(Buffer<T> *buffer,
+                                                         glm::vec2 uv,
+                                                         glm::ivec2 offset,
+                                                         S border) {
   glm::vec2 texUV = uv * glm::vec2(buffer->getWidth(), buffer->getHeight());
   auto x = (int) glm::floor(texUV.x) + offset.x;
   auto y = (int) glm::floor(texUV.y) + offset.y;
 
-  return pixelWithWrapMode(buffer, x, y, wrap, border);
+  return pixelWithWrapMode<L, W>(buffer, x, y, border);
 }
 
 template<typename T>
-T BaseSampler<T>::sampleBilinear(Buffer<T> *buffer,
-                                 glm::vec2 &uv,
-                                 WrapMode wrap,
-                                 glm::ivec2 &offset,
-                                 T border) {
+template<typename L, typename W>
+typename BaseSampler<T>::S BaseSampler<T>::sampleBilinear(Buffer<T> *buffer,
+                                                          glm::vec2 uv,
+                                                          glm::ivec2 offset,
+                                                          S border) {
   glm::vec2 texUV = uv * glm::vec2(buffer->getWidth(), buffer->getHeight());
   texUV.x += (float) offset.x;
   texUV.y += (float) offset.y;
-  return samplePixelBilinear(buffer, texUV, wrap, border);
-}
-
-template<typename T>
-void BaseSampler<T>::sampleBufferBilinear(Buffer<T> *buffer_out, Buffer<T> *buffer_in, T border) {
-  float ratio_x = (float) buffer_in->getWidth() / (float) buffer_out->getWidth();
-  float ratio_y = (float) buffer_in->getHeight() / (float) buffer_out->getHeight();
-  glm::vec2 delta = 0.5f * glm::vec2(ratio_x, ratio_y);
-  for (int y = 0; y < (int) buffer_out->getHeight(); y++) {
-    for (int x = 0; x < (int) buffer_out->getWidth(); x++) {
-      glm::vec2 uv = glm::vec2((float) x * ratio_x, (float) y * ratio_y) + delta;
-      auto color = samplePixelBilinear(buffer_in, uv, Wrap_CLAMP_TO_EDGE, border);
-      buffer_out->set(x, y, color);
-    }
-  }
+  return samplePixelBilinear<L, W>(buffer, texUV, border);
 }
 
 template<typename T>
-T BaseSampler<T>::samplePixelBilinear(Buffer<T> *buffer, glm::vec2 uv, WrapMode wrap, T border) {
+template<typename L, typename W>
+typename BaseSampler<T>::S BaseSampler<T>::samplePixelBilinear(Buffer<T> *buffer, glm::vec2 uv, S border) {
   auto x = (int) glm::floor(uv.x - 0.5f);
   auto y = (int) glm::floor(uv.y - 0.5f);
 
-  auto s1 = pixelWithWrapMode(buffer, x, y, wrap, border);
-  auto s2 = pixelWithWrapMode(buffer, x + 1, y, wrap, border);
-  auto s3 = pixelWithWrapMode(buffer, x, y + 1, wrap, border);
-  auto s4 = pixelWithWrapMode(buffer, x + 1, y + 1, wrap, border);
+  auto s1 = pixelWithWrapMode<L, W>(buffer, x, y, border);
+  auto s2 = pixelWithWrapMode<L, W>(buffer, x + 1, y, border);
+  auto s3 = pixelWithWrapMode<L, W>(buffer, x, y + 1, border);
+  auto s4 = pixelWithWrapMode<L, W>(buffer, x + 1, y + 1, border);
 
   glm::vec2 f = glm::fract(uv - glm::vec2(0.5f));
   return glm::mix(glm::mix(s1, s2, f.x), glm::mix(s3, s4, f.x), f.y);
 }
 
+#ifdef SOFTGL_SIMD_OPT
+static inline uint32_t loadTexelRGBA(const RGBA *texel) {
+  uint32_t v;
+  memcpy(&v, texel, sizeof(RGBA));
+  return v;
+}
+
+// texels t0, t1 in low 64 bits
+static inline __m128i packTexelPairRGBA(uint32_t t0, uint32_t t1) {
+  return _mm_cvtsi64_si128((long long) (((uint64_t) t1 << 32) | t0));
+}
+
+// RGBA8 bilinear in 16 bit fixed point: texels widened to v * 257 (255 -> 65535), sub-texel weights
+// scaled to 65536 and applied with _mm_mulhi_epu16, so each lerp is one multiply-high per side.
+// texel pairs adjacent in memory are fetched with one 64 bit load per row.
+// max error against the float path is about 1e-4 (see test/TestSamplerBilinear.cpp)
+template<>
+template<typename L, typename W>
+glm::vec4 BaseSampler<RGBA>::samplePixelBilinear(Buffer<RGBA> *buffer, glm::vec2 uv, glm::vec4 border) {
+  glm::vec2 pos = uv - glm::vec2(0.5f);
+  glm::vec2 base = glm::floor(pos);
+  auto wx = (uint16_t) std::min((int) ((pos.x - base.x) * 65536.f + 0.5f), 65535);
+  auto wy = (uint16_t) std::min((int) ((pos.y - base.y) * 65536.f + 0.5f), 65535);
+
+  int w = (int) buffer->getWidth();
+  int h = (int) buffer->getHeight();
+  int x0 = (int) base.x, x1 = x0 + 1;
+  int y0 = (int) base.y, y1 = y0 + 1;
+  bool inX0 = W::wrap(x0, w);
+  bool inX1 = W::wrap(x1, w);
+  bool inY0 = W::wrap(y0, h);
+  bool inY1 = W::wrap(y1, h);
+
+  uint32_t borderTexel = 0;
+  if (!(inX0 && inX1 && inY0 && inY1)) {
+    RGBA texel = TexelTraits<RGBA>::store(border);
+    borderTexel = loadTexelRGBA(&texel);
+  }
+
+  // rows[i]: texels (x0, y), (x1, y) in low 64 bits
+  __m128i rows[2];
+  bool pairLoad = inX0 && inX1 && x1 == x0 + 1 && L::adjacent(x0);
+  const int ys[2] = {y0, y1};
+  const bool inY[2] = {inY0, inY1};
+  for (int i = 0; i < 2; i++) {
+    if (!inY[i]) {
+      rows[i] = packTexelPairRGBA(borderTexel, borderTexel);
+    } else if (pairLoad) {
+      rows[i] = _mm_loadl_epi64((const __m128i *) buffer->template get<L>(x0, ys[i]));
+    } else {
+      rows[i] = packTexelPairRGBA(inX0 ? loadTexelRGBA(buffer->template get<L>(x0, ys[i])) : borderTexel,
+                                  inX1 ? loadTexelRGBA(buffer->template get<L>(x1, ys[i])) : borderTexel);
+    }
+  }
+
+  // 16 bit lanes 0-3: column x0 channels, lanes 4-7: column x1 channels
+  __m128i top = _mm_unpacklo_epi8(rows[0], rows[0]);
+  __m128i bottom = _mm_unpacklo_epi8(rows[1], rows[1]);
+
+  // vertical: (top * (65535 - wy) + bottom * wy) >> 16, 65535 - w is ~w
+  const __m128i ones = _mm_set1_epi32(-1);
+  __m128i weightY = _mm_set1_epi16((short) wy);
+  __m128i col = _mm_add_epi16(_mm_mulhi_epu16(top, _mm_xor_si128(weightY, ones)), _mm_mulhi_epu16(bottom, weightY));
+
+  // horizontal: (col0 * (65535 - wx) + col1 * wx) >> 16, upper half added onto lower half
+  __m128i weightX = _mm_set1_epi16((short) wx);
+  weightX = _mm_unpacklo_epi64(_mm_xor_si128(weightX, ones), weightX);
+  __m128i prod = _mm_mulhi_epu16(col, weightX);
+  __m128i sum = _mm_add_epi16(prod, _mm_srli_si128(prod, 8));
+
+  glm::vec4 ret;
+  __m128 sumF = _mm_cvtepi32_ps(_mm_unpacklo_epi16(sum, _mm_setzero_si128()));
+  _mm_storeu_ps(&ret.x, _mm_mul_ps(sumF, _mm_set1_ps(1.f / 65535.f)));
+  return ret;
+}
+#endif
+
 template<typename T>
 class BaseSamplerCube : public BaseSampler<T> {
  public:
+  using S = typename BaseSampler<T>::S;
+
   BaseSamplerCube() {
     BaseSampler<T>::wrapMode_ = Wrap_CLAMP_TO_EDGE;
     BaseSampler<T>::filterMode_ = Filter_LINEAR;
@@ -276,9 +464,7 @@ class BaseSamplerCube : public BaseSampler<T> {
   inline void setImage(TextureImageSoft<T> *tex, int idx) {
     texes_[idx] = tex;
     if (idx == 0) {
-      BaseSampler<T>::width_ = (tex == nullptr) ? 0 : tex->getWidth();
-      BaseSampler<T>::height_ = (tex == nullptr) ? 0 : tex->getHeight();
-      BaseSampler<T>::useMipmaps = BaseSampler<T>::filterMode_ > Filter_LINEAR;
+      BaseSampler<T>::updateImage(tex);
     }
   }
 
@@ -286,14 +472,14 @@ class BaseSamplerCube : public BaseSampler<T> {
     return texes_[0] == nullptr;
   }
 
-  T textureCubeImpl(glm::vec3 &coord, float bias = 0.f) {
+  S textureCubeImpl(glm::vec3 &coord, float bias = 0.f) {
     float lod = bias;
     // cube sampler derivative not support
     // lod += dFd()...
     return textureCubeLodImpl(coord, lod);
   }
 
-  T textureCubeLodImpl(glm::vec3 &coord, float lod = 0.f) {
+  S textureCubeLodImpl(glm::vec3 &coord, float lod = 0.f) {
     int index;
     glm::vec2 uv;
     convertXYZ2UV(coord.x, coord.y, coord.z, &index, &uv.x, &uv.y);
@@ -381,6 +567,8 @@ class SamplerSoft {
 template<typename T>
 class Sampler2DSoft : public SamplerSoft {
  public:
+  using S = typename TexelTraits<T>::Sample;
+
   TextureType texType() override {
     return TextureType_2D;
   }
@@ -397,19 +585,27 @@ class Sampler2DSoft : public SamplerSoft {
     return tex_;
   }
 
-  inline void setLodFunc(std::function<float(BaseSampler<T> *)> *func) {
-    sampler_.setLodFunc(func);
+  inline bool useMipmaps() const {
+    return sampler_.useMipmaps();
+  }
+
+  inline size_t width() const {
+    return sampler_.width();
   }
 
-  inline T texture2D(glm::vec2 coord, float bias = 0.f) {
+  inline size_t height() const {
+    return sampler_.height();
+  }
+
+  inline S texture2D(glm::vec2 coord, float bias = 0.f) {
     return sampler_.texture2DImpl(coord, bias);
   }
 
-  inline T texture2DLod(glm::vec2 coord, float lod = 0.f) {
+  inline S texture2DLod(glm::vec2 coord, float lod = 0.f) {
     return sampler_.texture2DLodImpl(coord, lod);
   }
 
-  inline T texture2DLodOffset(glm::vec2 coord, float lod, glm::ivec2 offset) {
+  inline S texture2DLodOffset(glm::vec2 coord, float lod, glm::ivec2 offset) {
     return sampler_.texture2DLodImpl(coord, lod, offset);
   }
 
@@ -421,6 +617,8 @@ class Sampler2DSoft : public SamplerSoft {
 template<typename T>
 class SamplerCubeSoft : public SamplerSoft {
  public:
+  using S = typename TexelTraits<T>::Sample;
+
   TextureType texType() override {
     return TextureType_CUBE;
   }
@@ -439,11 +637,11 @@ class SamplerCubeSoft : public SamplerSoft {
     return tex_;
   }
 
-  inline T textureCube(glm::vec3 coord, float bias = 0.f) {
+  inline S textureCube(glm::vec3 coord, float bias = 0.f) {
     return sampler_.textureCubeImpl(coord, bias);
   }
 
-  inline T textureCubeLod(glm::vec3 coord, float lod = 0.f) {
+  inline S textureCubeLod(glm::vec3 coord, float lod = 0.f) {
     return sampler_.textureCubeLodImpl(coord, lod);
   }
 
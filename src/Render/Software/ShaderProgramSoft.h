@@ -89,6 +89,10 @@ class ShaderProgramSoft : public ShaderProgram {
     return builtin_;
   }
 
+  inline int getFragDataCount() {
+    return fragmentShader_->getFragDataCount();
+  }
+
   inline void execVertexShader() {
     vertexShader_->shaderMain();
   }
@@ -98,7 +102,6 @@ class ShaderProgramSoft : public ShaderProgram {
   }
 
   inline void execFragmentShader() {
-    fragmentShader_->setupSamplerDerivative();
     fragmentShader_->shaderMain();
   }
 
@@ -109,10 +112,23 @@ class ShaderProgramSoft : public ShaderProgram {
     ret->fragmentShader_ = fragmentShader_->clone();
     ret->vertexShader_->bindBuiltin(&ret->builtin_);
     ret->fragmentShader_->bindBuiltin(&ret->builtin_);
+    ret->threadClones_.clear();
 
     return ret;
   }
 
+  // clone per thread, kept with the program and reused by later draws (uniforms & defines buffer are shared)
+  inline ShaderProgramSoft *getThreadClone(size_t threadId) {
+    if (threadClones_.size() <= threadId) {
+      threadClones_.resize(threadId + 1);
+    }
+    auto &program = threadClones_[threadId];
+    if (!program) {
+      program = clone();
+    }
+    return program.get();
+  }
+
  private:
   ShaderBuiltin builtin_;
   std::vector<std::string> defines_;
@@ -123,6 +139,8 @@ class ShaderProgramSoft : public ShaderProgram {
   std::shared_ptr<uint8_t> definesBuffer_;  // 0->false; 1->true
   std::shared_ptr<uint8_t> uniformBuffer_;
 
+  std::vector<std::shared_ptr<ShaderProgramSoft>> threadClones_;
+
  private:
   UUID<ShaderProgramSoft> uuid_;
 };
@@ -6,7 +6,7 @@
 
 #pragma once
 
-#include <functional>
+#include "Render/Framebuffer.h"
 #include "SamplerSoft.h"
 
 namespace SoftGL {
@@ -24,11 +24,21 @@ class UniformDesc {
   int offset;
 };
 
+// 2D sampler lod of current pixel quad, reset by renderer before quad shading
+struct LodCache {
+  bool valid = false;  // uv derivatives computed
+  glm::vec2 dx;
+  glm::vec2 dy;
+  glm::vec2 texSize = glm::vec2(0.f);  // samplers of same size share the lod
+  float lod = 0.f;
+};
+
 struct DerivativeContext {
   float *p0 = nullptr;
   float *p1 = nullptr;
   float *p2 = nullptr;
   float *p3 = nullptr;
+  LodCache lodCache;
 };
 
 struct ShaderBuiltin {
@@ -40,8 +50,10 @@ struct ShaderBuiltin {
   glm::vec4 FragCoord;
   bool FrontFacing;
 
-  // fragment shader output
+  // fragment shader output, FragColor is broadcast to all color attachments
+  // unless shader declares FragData outputs (see ShaderSoft::getFragDataCount)
   glm::vec4 FragColor;
+  glm::vec4 FragData[MAX_COLOR_ATTACHMENTS];
   bool discard = false;
 
   // derivative
@@ -66,6 +78,9 @@ class ShaderSoft {
 
   virtual std::shared_ptr<ShaderSoft> clone() = 0;
 
+  // number of FragData outputs written by fragment shader, 0 means FragColor only
+  virtual int getFragDataCount() { return 0; }
+
  public:
   static inline glm::ivec2 textureSize(Sampler2DSoft<RGBA> *sampler, int lod) {
     auto &buffer = sampler->getTexture()->getImage().getBuffer(lod);
@@ -77,9 +92,12 @@ class ShaderSoft {
     return {buffer->width, buffer->height};
   }
 
-  static inline glm::vec4 texture(Sampler2DSoft<RGBA> *sampler, glm::vec2 coord) {
-    glm::vec4 ret = sampler->texture2D(coord);
-    return ret / 255.f;
+  // lod from derivatives of the uv varying (see getSamplerDerivativeOffset)
+  inline glm::vec4 texture(Sampler2DSoft<RGBA> *sampler, glm::vec2 coord) const {
+    if (dfOffset_ >= 0 && sampler->useMipmaps()) {
+      return sampler->texture2DLod(coord, getSampler2DLod(sampler));
+    }
+    return sampler->texture2D(coord);
   }
 
   static inline float texture(Sampler2DSoft<float> *sampler, glm::vec2 coord) {
@@ -88,60 +106,94 @@ class ShaderSoft {
   }
 
   static inline glm::vec4 texture(SamplerCubeSoft<RGBA> *sampler, glm::vec3 coord) {
-    glm::vec4 ret = sampler->textureCube(coord);
-    return ret / 255.f;
+    return sampler->textureCube(coord);
   }
 
   static inline glm::vec4 textureLod(Sampler2DSoft<RGBA> *sampler, glm::vec2 coord, float lod = 0.f) {
-    glm::vec4 ret = sampler->texture2DLod(coord, lod);
-    return ret / 255.f;
+    return sampler->texture2DLod(coord, lod);
   }
 
   static inline glm::vec4 textureLod(SamplerCubeSoft<RGBA> *sampler, glm::vec3 coord, float lod = 0.f) {
-    glm::vec4 ret = sampler->textureCubeLod(coord, lod);
-    return ret / 255.f;
+    return sampler->textureCubeLod(coord, lod);
+  }
+
+  // hdr formats, sampled value is not normalized
+  static inline glm::vec4 texture(Sampler2DSoft<RGBA16F> *sampler, glm::vec2 coord) {
+    return sampler->texture2D(coord);
+  }
+
+  static inline glm::vec4 texture(Sampler2DSoft<RGBA32F> *sampler, glm::vec2 coord) {
+    return sampler->texture2D(coord);
+  }
+
+  static inline glm::vec4 texture(SamplerCubeSoft<RGBA16F> *sampler, glm::vec3 coord) {
+    return sampler->textureCube(coord);
+  }
+
+  static inline glm::vec4 texture(SamplerCubeSoft<RGBA32F> *sampler, glm::vec3 coord) {
+    return sampler->textureCube(coord);
+  }
+
+  static inline glm::vec4 textureLod(Sampler2DSoft<RGBA16F> *sampler, glm::vec2 coord, float lod = 0.f) {
+    return sampler->texture2DLod(coord, lod);
+  }
+
+  static inline glm::vec4 textureLod(Sampler2DSoft<RGBA32F> *sampler, glm::vec2 coord, float lod = 0.f) {
+    return sampler->texture2DLod(coord, lod);
+  }
+
+  static inline glm::vec4 textureLod(SamplerCubeSoft<RGBA16F> *sampler, glm::vec3 coord, float lod = 0.f) {
+    return sampler->textureCubeLod(coord, lod);
+  }
+
+  static inline glm::vec4 textureLod(SamplerCubeSoft<RGBA32F> *sampler, glm::vec3 coord, float lod = 0.f) {
+    return sampler->textureCubeLod(coord, lod);
   }
 
   static inline glm::vec4 textureLodOffset(Sampler2DSoft<RGBA> *sampler,
                                            glm::vec2 coord,
                                            float lod,
                                            glm::ivec2 offset) {
-    glm::vec4 ret = sampler->texture2DLodOffset(coord, lod, offset);
-    return ret / 255.f;
+    return sampler->texture2DLodOffset(coord, lod, offset);
   }
 
  public:
   ShaderBuiltin *gl = nullptr;
-  std::function<float(BaseSampler<RGBA> *)> texLodFunc;
 
-  float getSampler2DLod(BaseSampler<RGBA> *sampler) const {
+  // uv derivatives are computed once per quad, lod once per quad & texture size
+  float getSampler2DLod(Sampler2DSoft<RGBA> *sampler) const {
     auto &dfCtx = gl->dfCtx;
-    size_t dfOffset = getSamplerDerivativeOffset(sampler);
-
-    auto *coord0 = (glm::vec2 *) (dfCtx.p0 + dfOffset);
-    auto *coord1 = (glm::vec2 *) (dfCtx.p1 + dfOffset);
-    auto *coord2 = (glm::vec2 *) (dfCtx.p2 + dfOffset);
-    auto *coord3 = (glm::vec2 *) (dfCtx.p3 + dfOffset);
+    auto &cache = dfCtx.lodCache;
+    if (!cache.valid) {
+      auto *coord0 = (glm::vec2 *) ((uint8_t *) dfCtx.p0 + dfOffset_);
+      auto *coord1 = (glm::vec2 *) ((uint8_t *) dfCtx.p1 + dfOffset_);
+      auto *coord2 = (glm::vec2 *) ((uint8_t *) dfCtx.p2 + dfOffset_);
+      cache.dx = *coord1 - *coord0;
+      cache.dy = *coord2 - *coord0;
+      cache.texSize = glm::vec2(0.f);
+      cache.valid = true;
+    }
 
     glm::vec2 texSize = glm::vec2(sampler->width(), sampler->height());
-    glm::vec2 dx = glm::vec2(*coord1 - *coord0);
-    glm::vec2 dy = glm::vec2(*coord2 - *coord0);
-    dx *= texSize;
-    dy *= texSize;
-    float d = glm::max(glm::dot(dx, dx), glm::dot(dy, dy));
-    return glm::max(0.5f * glm::log2(d), 0.0f);
+    if (cache.texSize != texSize) {
+      glm::vec2 dx = cache.dx * texSize;
+      glm::vec2 dy = cache.dy * texSize;
+      float d = glm::max(glm::dot(dx, dx), glm::dot(dy, dy));
+      cache.lod = glm::max(0.5f * glm::log2(d), 0.0f);
+      cache.texSize = texSize;
+    }
+    return cache.lod;
   }
 
   virtual void prepareExecMain() {
-    texLodFunc = std::bind(&ShaderSoft::getSampler2DLod, this, std::placeholders::_1);
+    dfOffset_ = getSamplerDerivativeOffset();
   }
 
-  virtual size_t getSamplerDerivativeOffset(BaseSampler<RGBA> *sampler) const {
-    return 0;
+  // byte offset of uv varying used for 2D sampler lod, -1 if not supported
+  virtual int getSamplerDerivativeOffset() const {
+    return -1;
   }
 
-  virtual void setupSamplerDerivative() {}
-
   int getUniformLocation(const std::string &name) {
     auto &desc = getUniformsDesc();
     for (int i = 0; i < desc.size(); i++) {
@@ -159,6 +211,9 @@ class ShaderSoft {
     }
     return desc[loc].offset;
   };
+
+ protected:
+  int dfOffset_ = -1;
 };
 
 #define CREATE_SHADER_OVERRIDE                          \
@@ -9,28 +9,54 @@
 #include <fstream>
 #include "Base/UUID.h"
 #include "Base/Buffer.h"
+#include "Base/HalfFloat.h"
 #include "Base/ImageUtils.h"
+#include "Base/ThreadPool.h"
 #include "Render/Texture.h"
 
 namespace SoftGL {
 
 #define SOFT_MS_CNT 4
 
+// texel storage type -> filtering & shading type
+template<typename T>
+struct TexelTraits {
+  using Sample = T;
+  static inline const T &load(const T &v) { return v; }
+  static inline const T &store(const T &v) { return v; }
+};
+
+// RGBA8 is sampled as normalized float
+template<>
+struct TexelTraits<RGBA> {
+  using Sample = glm::vec4;
+  static inline glm::vec4 load(const RGBA &v) { return glm::vec4(v) / 255.f; }
+  static inline RGBA store(const glm::vec4 &v) { return RGBA(glm::clamp(v * 255.f + 0.5f, 0.f, 255.f)); }
+};
+
+template<>
+struct TexelTraits<RGBA16F> {
+  using Sample = glm::vec4;
+  static inline glm::vec4 load(const RGBA16F &v) { return glm::vec4(v); }
+  static inline RGBA16F store(const glm::vec4 &v) { return RGBA16F(v); }
+};
+
 template<typename T>
 class ImageBufferSoft {
  public:
   ImageBufferSoft() = default;
 
-  ImageBufferSoft(int w, int h, int samples = 1) {
+  ImageBufferSoft(int w, int h, int samples = 1, BufferLayout layout = Layout_Linear) {
     width = w;
     height = h;
     multiSample = samples > 1;
     sampleCnt = samples;
+    this->layout = layout;
 
     if (samples == 1) {
-      buffer = Buffer<T>::makeDefault(w, h);
+      buffer = Buffer<T>::makeLayout(w, h, layout);
     } else if (samples == 4) {
-      bufferMs4x = Buffer<glm::tvec4<T>>::makeDefault(w, h);
+      bufferMs4x = Buffer<glm::tvec4<T>>::makeLayout(w, h, layout);
     } else {
       LOGE("create color buffer failed: samplers not support");
     }
@@ -41,6 +67,7 @@ class ImageBufferSoft {
     height = (int) buf->getHeight();
     multiSample = false;
     sampleCnt = 1;
+    layout = buf->getLayout();
     buffer = buf;
   }
 
@@ -52,6 +79,7 @@ class ImageBufferSoft {
   int height = 0;
   bool multiSample = false;
   int sampleCnt = 1;
+  BufferLayout layout = Layout_Linear;
 };
 
 template<typename T>
@@ -90,6 +118,7 @@ class TextureSoft : public Texture {
     usage = desc.usage;
     useMipmaps = desc.useMipmaps;
     multiSample = desc.multiSample;
+    layout = desc.layout;
 
     switch (type) {
       case TextureType_2D:
@@ -123,28 +152,27 @@ class TextureSoft : public Texture {
       return;
     }
 
-    for (int i = 0; i < layerCount_; i++) {
-      images_[i].levels.resize(1);
-      images_[i].levels[0] = std::make_shared<ImageBufferSoft<T>>(buffers[i]);
-
-      if (useMipmaps) {
-        images_[i].generateMipmap();
+    // cube faces in parallel, mipmap rows are split further inside
+    ThreadPool::shared().parallelFor(0, layerCount_, 1, [&](size_t begin, size_t end, size_t) {
+      for (size_t i = begin; i < end; i++) {
+        setLayerImageData(images_[i], buffers[i]);
       }
-    }
+    });
   }
 
   void initImageData() override {
     for (auto &image : images_) {
       image.levels.resize(1);
-      image.levels[0] = std::make_shared<ImageBufferSoft<T>>(width, height, multiSample ? SOFT_MS_CNT : 1);
+      image.levels[0] = std::make_shared<ImageBufferSoft<T>>(width, height, multiSample ? SOFT_MS_CNT : 1, layout);
       if (useMipmaps) {
         image.generateMipmap(false);
       }
     }
   }
 
-  void dumpImage(const char *path, uint32_t layer, uint32_t level) override {
-    dumpImageSoft(path, images_[layer], level);
+  void dumpImage(const char *path, uint32_t layer, uint32_t level,
+                 ImageDumpMode mode = ImageDump_DEFAULT) override {
+    dumpImageSoft(path, images_[layer], level, mode);
   }
 
   inline SamplerDesc &getSamplerDesc() {
@@ -163,6 +191,10 @@ class TextureSoft : public Texture {
     ret = glm::clamp(cvtBorderColor(samplerDesc_.borderColor) * 255.f, {0, 0, 0, 0}, {255, 255, 255, 255});
   }
 
+  inline void getBorderColor(glm::vec4 &ret) {
+    ret = cvtBorderColor(samplerDesc_.borderColor);
+  }
+
   bool loadFromFile(const char *path) {
     std::ifstream file(path, std::ios::in | std::ios::binary);
     if (!file.is_open()) {
@@ -175,9 +207,9 @@ class TextureSoft : public Texture {
       for (int level = 0; level < layer.levels.size(); level++) {
         auto &img = layer.getBuffer(level);
         if (multiSample) {
-          file.read((char *) img->bufferMs4x->getRawDataPtr(), img->bufferMs4x->getRawDataBytesSize());
+          readBuffer(file, *img->bufferMs4x);
         } else {
-          file.read((char *) img->buffer->getRawDataPtr(), img->buffer->getRawDataBytesSize());
+          readBuffer(file, *img->buffer);
         }
       }
     }
@@ -204,9 +236,9 @@ class TextureSoft : public Texture {
       for (int level = 0; level < layer.levels.size(); level++) {
         auto &img = layer.getBuffer(level);
         if (multiSample) {
-          file.write((char *) img->bufferMs4x->getRawDataPtr(), img->bufferMs4x->getRawDataBytesSize());
+          writeBuffer(file, *img->bufferMs4x);
         } else {
-          file.write((char *) img->buffer->getRawDataPtr(), img->buffer->getRawDataBytesSize());
+          writeBuffer(file, *img->buffer);
         }
       }
     }
@@ -215,6 +247,53 @@ class TextureSoft : public Texture {
   }
 
  protected:
+  void setLayerImageData(TextureImageSoft<T> &image, const std::shared_ptr<Buffer<T>> &buffer) {
+    image.levels.resize(1);
+    if (buffer->getLayout() == layout) {
+      image.levels[0] = std::make_shared<ImageBufferSoft<T>>(buffer);
+    } else {
+      // store in texture layout
+      auto level0 = std::make_shared<ImageBufferSoft<T>>(width, height, 1, layout);
+      if (buffer->getLayout() == Layout_Linear) {
+        level0->buffer->copyLinearDataFrom(buffer->getRawDataPtr());
+      } else {
+        for (size_t y = 0; y < height; y++) {
+          for (size_t x = 0; x < width; x++) {
+            level0->buffer->set(x, y, *buffer->get(x, y));
+          }
+        }
+      }
+      image.levels[0] = level0;
+    }
+
+    if (useMipmaps) {
+      image.generateMipmap();
+    }
+  }
+
+  // file data is in row order, independent of buffer layout
+  template<typename P>
+  static void readBuffer(std::ifstream &file, Buffer<P> &buffer) {
+    if (buffer.getLayout() == Layout_Linear) {
+      file.read((char *) buffer.getRawDataPtr(), buffer.getRawDataBytesSize());
+      return;
+    }
+    std::vector<P> pixels(buffer.getWidth() * buffer.getHeight());
+    file.read((char *) pixels.data(), pixels.size() * sizeof(P));
+    buffer.copyLinearDataFrom(pixels.data());
+  }
+
+  template<typename P>
+  static void writeBuffer(std::ofstream &file, Buffer<P> &buffer) {
+    if (buffer.getLayout() == Layout_Linear) {
+      file.write((char *) buffer.getRawDataPtr(), buffer.getRawDataBytesSize());
+      return;
+    }
+    std::vector<P> pixels(buffer.getWidth() * buffer.getHeight());
+    buffer.copyLinearDataTo(pixels.data());
+    file.write((char *) pixels.data(), pixels.size() * sizeof(P));
+  }
+
   static inline glm::vec4 cvtBorderColor(BorderColor color) {
     switch (color) {
       case Border_BLACK:
@@ -227,19 +306,39 @@ class TextureSoft : public Texture {
     return glm::vec4(0.f);
   }
 
-  void dumpImageSoft(const char *path, TextureImageSoft<T> image, uint32_t level) {
+  void dumpImageSoft(const char *path, TextureImageSoft<T> &image, uint32_t level, ImageDumpMode mode) {
     if (multiSample) {
       return;
     }
 
-    void *pixels = image.getBuffer(level)->buffer->getRawDataPtr();
+    auto &buffer = image.getBuffer(level)->buffer;
+    void *pixels = buffer->getRawDataPtr();
+    std::vector<T> linearPixels;
+    if (buffer->getLayout() != Layout_Linear) {
+      linearPixels.resize(buffer->getWidth() * buffer->getHeight());
+      buffer->copyLinearDataTo(linearPixels.data());
+      pixels = linearPixels.data();
+    }
     auto levelWidth = (int32_t) getLevelWidth(level);
     auto levelHeight = (int32_t) getLevelHeight(level);
 
     // convert float to rgba
     if (format == TextureFormat_FLOAT32) {
       auto *rgba_pixels = new uint8_t[levelWidth * levelHeight * 4];
-      ImageUtils::convertFloatImage(reinterpret_cast<RGBA *>(rgba_pixels), reinterpret_cast<float *>(pixels), levelWidth, levelHeight);
+      if (mode == ImageDump_HEATMAP) {
+        ImageUtils::convertHeatmapImage(reinterpret_cast<RGBA *>(rgba_pixels), reinterpret_cast<float *>(pixels), levelWidth, levelHeight);
+      } else {
+        ImageUtils::convertFloatImage(reinterpret_cast<RGBA *>(rgba_pixels), reinterpret_cast<float *>(pixels), levelWidth, levelHeight);
+      }
+      ImageUtils::writeImage(path, levelWidth, levelHeight, 4, rgba_pixels, levelWidth * 4, true);
+      delete[] rgba_pixels;
+    } else if (format == TextureFormat_RGBA16F || format == TextureFormat_RGBA32F) {
+      // hdr: clamp to [0, 1]
+      auto *rgba_pixels = new RGBA[levelWidth * levelHeight];
+      auto *texels = reinterpret_cast<T *>(pixels);
+      for (int i = 0; i < levelWidth * levelHeight; i++) {
+        rgba_pixels[i] = glm::clamp(glm::vec4(texels[i]), 0.f, 1.f) * 255.f;
+      }
       ImageUtils::writeImage(path, levelWidth, levelHeight, 4, rgba_pixels, levelWidth * 4, true);
       delete[] rgba_pixels;
     } else {
@@ -53,6 +53,12 @@ class UniformSamplerSoft : public UniformSampler {
           case TextureFormat_FLOAT32:
             sampler_ = std::make_shared<Sampler2DSoft<float>>();
             break;
+          case TextureFormat_RGBA16F:
+            sampler_ = std::make_shared<Sampler2DSoft<RGBA16F>>();
+            break;
+          case TextureFormat_RGBA32F:
+            sampler_ = std::make_shared<Sampler2DSoft<RGBA32F>>();
+            break;
         }
         break;
       case TextureType_CUBE:
@@ -63,6 +69,12 @@ class UniformSamplerSoft : public UniformSampler {
           case TextureFormat_FLOAT32:
             sampler_ = std::make_shared<SamplerCubeSoft<float>>();
             break;
+          case TextureFormat_RGBA16F:
+            sampler_ = std::make_shared<SamplerCubeSoft<RGBA16F>>();
+            break;
+          case TextureFormat_RGBA32F:
+            sampler_ = std::make_shared<SamplerCubeSoft<RGBA32F>>();
+            break;
         }
         break;
       default:
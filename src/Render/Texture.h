@@ -11,6 +11,7 @@
 #include <vector>
 #include "Base/Buffer.h"
 #include "Base/GLMInc.h"
+#include "Base/HalfFloat.h"
 
 namespace SoftGL {
 
@@ -63,6 +64,8 @@ enum TextureType {
 enum TextureFormat {
   TextureFormat_RGBA8 = 0,      // RGBA8888
   TextureFormat_FLOAT32 = 1,    // Float32
+  TextureFormat_RGBA16F = 2,    // RGBA half float
+  TextureFormat_RGBA32F = 3,    // RGBA float
 };
 
 enum TextureUsage {
@@ -73,6 +76,11 @@ enum TextureUsage {
   TextureUsage_RendererOutput = 1 << 4,
 };
 
+enum ImageDumpMode {
+  ImageDump_DEFAULT,
+  ImageDump_HEATMAP,    // false color, only for float format
+};
+
 struct TextureDesc {
   int width = 0;
   int height = 0;
@@ -81,6 +89,7 @@ struct TextureDesc {
   uint32_t usage = TextureUsage_Sampler;
   bool useMipmaps = false;
   bool multiSample = false;
+  BufferLayout layout = Layout_Linear;  // software renderer storage layout
   std::string tag;
 };
 
@@ -101,7 +110,10 @@ class Texture : public TextureDesc {
   virtual void initImageData() {};
   virtual void setImageData(const std::vector<std::shared_ptr<Buffer<RGBA>>> &buffers) {};
   virtual void setImageData(const std::vector<std::shared_ptr<Buffer<float>>> &buffers) {};
-  virtual void dumpImage(const char *path, uint32_t layer, uint32_t level) = 0;
+  virtual void setImageData(const std::vector<std::shared_ptr<Buffer<RGBA16F>>> &buffers) {};
+  virtual void setImageData(const std::vector<std::shared_ptr<Buffer<RGBA32F>>> &buffers) {};
+  virtual void dumpImage(const char *path, uint32_t layer, uint32_t level,
+                         ImageDumpMode mode = ImageDump_DEFAULT) = 0;
 };
 
 }
@@ -34,6 +34,8 @@ static inline VkFormat cvtImageFormat(TextureFormat format, uint32_t usage) {
     switch (format) {
       case TextureFormat_RGBA8:   return VK_FORMAT_R8G8B8A8_UNORM;
       case TextureFormat_FLOAT32: return VK_FORMAT_R32_SFLOAT;
+      case TextureFormat_RGBA16F: return VK_FORMAT_R16G16B16A16_SFLOAT;
+      case TextureFormat_RGBA32F: return VK_FORMAT_R32G32B32A32_SFLOAT;
       default:
         break;
     }
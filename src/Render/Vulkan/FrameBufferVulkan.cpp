@@ -101,7 +101,7 @@ bool FrameBufferVulkan::createVkFramebuffer() {
 
   if (colorReady_) {
     auto *texColor = getAttachmentColor();
-    currFbo_->attachments.push_back(texColor->createAttachmentView(VK_IMAGE_ASPECT_COLOR_BIT, colorAttachment_.layer, colorAttachment_.level));
+    currFbo_->attachments.push_back(texColor->createAttachmentView(VK_IMAGE_ASPECT_COLOR_BIT, colorAttachments_[0].layer, colorAttachments_[0].level));
   }
   if (depthReady_) {
     auto *texDepth = getAttachmentDepth();
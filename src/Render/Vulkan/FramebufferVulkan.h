@@ -47,12 +47,12 @@ class FrameBufferVulkan : public FrameBuffer {
   }
 
   void setColorAttachment(std::shared_ptr<Texture> &color, int level) override {
-    if (color == colorAttachment_.tex && level == colorAttachment_.level) {
+    if (color == colorAttachments_[0].tex && level == colorAttachments_[0].level) {
       return;
     }
 
     fboDirty_ = true;
-    if (color != colorAttachment_.tex) {
+    if (color != colorAttachments_[0].tex) {
       renderPassDirty_ = true;
     }
 
@@ -62,12 +62,12 @@ class FrameBufferVulkan : public FrameBuffer {
   }
 
   void setColorAttachment(std::shared_ptr<Texture> &color, CubeMapFace face, int level) override {
-    if (color == colorAttachment_.tex && face == colorAttachment_.layer && level == colorAttachment_.level) {
+    if (color == colorAttachments_[0].tex && face == colorAttachments_[0].layer && level == colorAttachments_[0].level) {
       return;
     }
 
     fboDirty_ = true;
-    if (color != colorAttachment_.tex) {
+    if (color != colorAttachments_[0].tex) {
       renderPassDirty_ = true;
     }
 
@@ -76,6 +76,15 @@ class FrameBufferVulkan : public FrameBuffer {
     height_ = color->getLevelHeight(level);
   }
 
+  // render pass & pipelines of vulkan backend have a single color attachment, only index 0 is accepted
+  void setColorAttachment(int index, std::shared_ptr<Texture> &color, int level) override {
+    if (index != 0) {
+      LOGE("setColorAttachment failed: vulkan backend only supports color attachment 0, index: %d", index);
+      return;
+    }
+    setColorAttachment(color, level);
+  }
+
   void setDepthAttachment(std::shared_ptr<Texture> &depth) override {
     if (depth == depthAttachment_.tex) {
       return;
@@ -147,7 +156,7 @@ class FrameBufferVulkan : public FrameBuffer {
 
   inline TextureVulkan *getAttachmentColor() {
     if (colorReady_) {
-      return dynamic_cast<TextureVulkan *>(colorAttachment_.tex.get());
+      return dynamic_cast<TextureVulkan *>(colorAttachments_[0].tex.get());
     }
     return nullptr;
   }
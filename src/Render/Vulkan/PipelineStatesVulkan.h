@@ -100,8 +100,8 @@ class PipelineStatesVulkan : public PipelineStates {
     depthStencil.stencilTestEnable = VK_FALSE;
 
     VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-    colorBlendAttachment.colorWriteMask =
-        VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    colorBlendAttachment.colorWriteMask = renderStates.colorMask ?
+        VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT : 0;
     colorBlendAttachment.blendEnable = renderStates.blend ? VK_TRUE : VK_FALSE;
     colorBlendAttachment.colorBlendOp = VK::cvtBlendFunction(renderStates.blendParams.blendFuncRgb);
     colorBlendAttachment.srcColorBlendFactor = VK::cvtBlendFactor(renderStates.blendParams.blendSrcRgb);
@@ -70,7 +70,8 @@ std::shared_ptr<UniformSampler> RendererVulkan::createUniformSampler(const std::
 }
 
 // pipeline
-void RendererVulkan::beginRenderPass(std::shared_ptr<FrameBuffer> &frameBuffer, const ClearStates &states) {
+void RendererVulkan::beginRenderPass(std::shared_ptr<FrameBuffer> &frameBuffer, const ClearStates &states,
+                                     const Rect2D &renderArea) {
   if (!frameBuffer) {
     return;
   }
@@ -104,8 +105,11 @@ void RendererVulkan::beginRenderPass(std::shared_ptr<FrameBuffer> &frameBuffer,
   renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
   renderPassInfo.renderPass = fbo_->getRenderPass();
   renderPassInfo.framebuffer = fbo_->getVkFramebuffer();
-  renderPassInfo.renderArea.offset = {0, 0};
-  renderPassInfo.renderArea.extent = {fbo_->width(), fbo_->height()};
+  Rect2D fboRect{};
+  fboRect.width = (int) fbo_->width();
+  fboRect.height = (int) fbo_->height();
+  renderArea_ = renderArea.empty() ? fboRect : renderArea.intersect(fboRect);
+  renderPassInfo.renderArea = cvtRect2D(renderArea_);
   renderPassInfo.clearValueCount = clearValues_.size();
   renderPassInfo.pClearValues = clearValues_.data();
 
@@ -158,8 +162,16 @@ void RendererVulkan::draw() {
   vkCmdBindPipeline(drawCmd_, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineStates_->getGraphicsPipeline());
 
   // viewport & scissor
+  Rect2D viewportRect{};
+  viewportRect.width = (int) scissor_.extent.width;
+  viewportRect.height = (int) scissor_.extent.height;
+  Rect2D scissor = renderArea_.intersect(viewportRect);
+  if (pipelineStates_->renderStates.scissorTest) {
+    scissor = scissor.intersect(pipelineStates_->renderStates.scissor);
+  }
+  VkRect2D vkScissor = cvtRect2D(scissor);
   vkCmdSetViewport(drawCmd_, 0, 1, &viewport_);
-  vkCmdSetScissor(drawCmd_, 0, 1, &scissor_);
+  vkCmdSetScissor(drawCmd_, 0, 1, &vkScissor);
 
   // vertex buffer
   VkBuffer vertexBuffers[] = {vao_->getVertexBuffer()};
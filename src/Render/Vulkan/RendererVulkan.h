@@ -42,7 +42,8 @@ class RendererVulkan : public Renderer {
   std::shared_ptr<UniformSampler> createUniformSampler(const std::string &name, const TextureDesc &desc) override;
 
   // pipeline
-  void beginRenderPass(std::shared_ptr<FrameBuffer> &frameBuffer, const ClearStates &states) override;
+  void beginRenderPass(std::shared_ptr<FrameBuffer> &frameBuffer, const ClearStates &states,
+                       const Rect2D &renderArea = {}) override;
   void setViewPort(int x, int y, int width, int height) override;
   void setVertexArrayObject(std::shared_ptr<VertexArrayObject> &vao) override;
   void setShaderProgram(std::shared_ptr<ShaderProgram> &program) override;
@@ -52,6 +53,14 @@ class RendererVulkan : public Renderer {
   void endRenderPass() override;
   void waitIdle() override;
 
+ private:
+  static inline VkRect2D cvtRect2D(const Rect2D &rect) {
+    VkRect2D ret{};
+    ret.offset = {rect.x, rect.y};
+    ret.extent = {(uint32_t) rect.width, (uint32_t) rect.height};
+    return ret;
+  }
+
  public:
   inline VKContext &getVkCtx() {
     return vkCtx_;
@@ -65,6 +74,7 @@ class RendererVulkan : public Renderer {
 
   VkViewport viewport_{};
   VkRect2D scissor_{};
+  Rect2D renderArea_{};
   std::vector<VkClearValue> clearValues_;
 
   VKContext vkCtx_;
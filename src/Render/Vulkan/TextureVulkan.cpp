@@ -109,11 +109,16 @@ void TextureVulkan::initImageData() {
   }
 }
 
-void TextureVulkan::dumpImage(const char *path, uint32_t layer, uint32_t level) {
+void TextureVulkan::dumpImage(const char *path, uint32_t layer, uint32_t level, ImageDumpMode mode) {
   if (multiSample) {
     return;
   }
 
+  if (format == TextureFormat_RGBA16F || format == TextureFormat_RGBA32F) {
+    LOGE("dumpImage not support: hdr format");
+    return;
+  }
+
   readPixels(layer, level, [&](uint8_t *buffer, uint32_t w, uint32_t h, uint32_t rowStride) -> void {
     auto *pixels = new uint8_t[w * h * 4];
     for (uint32_t i = 0; i < h; i++) {
@@ -122,7 +127,11 @@ void TextureVulkan::dumpImage(const char *path, uint32_t layer, uint32_t level)
 
     // convert float to rgba
     if (format == TextureFormat_FLOAT32) {
-      ImageUtils::convertFloatImage(reinterpret_cast<RGBA *>(pixels), reinterpret_cast<float *>(pixels), w, h);
+      if (mode == ImageDump_HEATMAP) {
+        ImageUtils::convertHeatmapImage(reinterpret_cast<RGBA *>(pixels), reinterpret_cast<float *>(pixels), w, h);
+      } else {
+        ImageUtils::convertFloatImage(reinterpret_cast<RGBA *>(pixels), reinterpret_cast<float *>(pixels), w, h);
+      }
     }
     ImageUtils::writeImage(path, (int) w, (int) h, 4, pixels, (int) w * 4, true);
     delete[] pixels;
@@ -463,34 +472,24 @@ void TextureVulkan::generateMipmaps() {
 }
 
 void TextureVulkan::setImageData(const std::vector<std::shared_ptr<Buffer<RGBA>>> &buffers) {
-  if (format != TextureFormat_RGBA8) {
-    LOGE("setImageData error: format not match");
-    return;
-  }
-
-  if (buffers.size() != layerCount_) {
-    LOGE("setImageData error: layer count not match");
-    return;
-  }
+  setImageDataImpl(buffers, TextureFormat_RGBA8);
+}
 
-  auto &dataBuffer = buffers[0];
-  if (dataBuffer->getRawDataSize() != width * height) {
-    LOGE("setImageData error: size not match");
-    return;
-  }
+void TextureVulkan::setImageData(const std::vector<std::shared_ptr<Buffer<float>>> &buffers) {
+  setImageDataImpl(buffers, TextureFormat_FLOAT32);
+}
 
-  VkDeviceSize imageSize = dataBuffer->getRawDataBytesSize();
-  std::vector<const void *> buffersPtr;
-  buffersPtr.reserve(buffers.size());
-  for (auto &buff : buffers) {
-    buffersPtr.push_back(buff->getRawDataPtr());
-  }
+void TextureVulkan::setImageData(const std::vector<std::shared_ptr<Buffer<RGBA16F>>> &buffers) {
+  setImageDataImpl(buffers, TextureFormat_RGBA16F);
+}
 
-  setImageDataInternal(buffersPtr, imageSize);
+void TextureVulkan::setImageData(const std::vector<std::shared_ptr<Buffer<RGBA32F>>> &buffers) {
+  setImageDataImpl(buffers, TextureFormat_RGBA32F);
 }
 
-void TextureVulkan::setImageData(const std::vector<std::shared_ptr<Buffer<float>>> &buffers) {
-  if (format != TextureFormat_FLOAT32) {
+template<typename T>
+void TextureVulkan::setImageDataImpl(const std::vector<std::shared_ptr<Buffer<T>>> &buffers, TextureFormat bufferFormat) {
+  if (format != bufferFormat) {
     LOGE("setImageData error: format not match");
     return;
   }
@@ -32,12 +32,16 @@ class TextureVulkan : public Texture {
 
   void initImageData() override;
 
-  void dumpImage(const char *path, uint32_t w, uint32_t h) override;
+  void dumpImage(const char *path, uint32_t w, uint32_t h, ImageDumpMode mode = ImageDump_DEFAULT) override;
 
   void setImageData(const std::vector<std::shared_ptr<Buffer<RGBA>>> &buffers) override;
 
   void setImageData(const std::vector<std::shared_ptr<Buffer<float>>> &buffers) override;
 
+  void setImageData(const std::vector<std::shared_ptr<Buffer<RGBA16F>>> &buffers) override;
+
+  void setImageData(const std::vector<std::shared_ptr<Buffer<RGBA32F>>> &buffers) override;
+
   void readPixels(uint32_t layer, uint32_t level,
                   const std::function<void(uint8_t *buffer, uint32_t width, uint32_t height, uint32_t rowStride)> &func);
 
@@ -71,6 +75,10 @@ class TextureVulkan : public Texture {
         return sizeof(RGBA);
       case TextureFormat_FLOAT32:
         return sizeof(float);
+      case TextureFormat_RGBA16F:
+        return sizeof(RGBA16F);
+      case TextureFormat_RGBA32F:
+        return sizeof(RGBA32F);
     }
     return 0;
   }
@@ -126,6 +134,8 @@ class TextureVulkan : public Texture {
   bool createImageHost(uint32_t level);
   void createImageView(VkImageView &view, VkImage &image);
   void generateMipmaps();
+  template<typename T>
+  void setImageDataImpl(const std::vector<std::shared_ptr<Buffer<T>>> &buffers, TextureFormat bufferFormat);
   void setImageDataInternal(const std::vector<const void *> &buffers, VkDeviceSize imageSize);
 
  protected:
@@ -31,6 +31,19 @@ class Config {
 
   size_t triangleCount_ = 0;
 
+  // frames reused from cache in last 60 frames (0 ~ 1)
+  float frameSkipRate_ = 0.f;
+
+  // render resolution scale of last frame
+  float resolutionScale_ = 1.f;
+
+  // main pass area re-rendered in last frame (0 ~ 1)
+  float redrawRatio_ = 1.f;
+
+  // pipeline statistics of last frame, only valid if renderer supported
+  bool frameStatsValid_ = false;
+  PipelineStatistics frameStats_;
+
   bool wireframe = false;
   bool worldAxis = true;
   bool showSkybox = false;
@@ -44,6 +57,15 @@ class Config {
   bool depthTest = true;
   bool reverseZ = false;
 
+  // only re-render regions of changed objects when camera is static
+  bool partialRedraw = false;
+
+  // reuse last frame if camera, scene and config not changed
+  bool frameCache = true;
+
+  // skip meshes occluded in last frame, need renderer occlusion query support
+  bool occlusionCull = false;
+
   glm::vec4 clearColor = {0.f, 0.f, 0.f, 0.f};
   glm::vec3 ambientColor = {0.5f, 0.5f, 0.5f};
 
@@ -53,6 +75,32 @@ class Config {
 
   int aaType = AAType_NONE;
   int rendererType = Renderer_SOFT;
+
+  // shading cost heatmap (ShadingCostMode), software renderer only
+  int shadingCostMode = 0;
+
+  // coarse shading rate of meshes (ShadingRate), software renderer only
+  int shadingRate = 0;
+
+  // scale render resolution to keep frame time under budget, software renderer only
+  bool dynamicResolution = false;
+  float frameTimeBudget = 33.3f;    // ms
+  float minResolutionScale = 0.5f;
+  float maxResolutionScale = 1.f;
+
+  // shared render threads, applied once at startup (changes need restart),
+  // env SOFTGL_THREADS / SOFTGL_THREAD_PIN / SOFTGL_NUMA_NODE override
+  int threadCount = 0;      // 0: one per cpu
+  bool threadPinning = false;
+  int numaNode = -1;        // -1: any node
+
+  // storage layout (BufferLayout) of attachments & sampled textures, software renderer only,
+  // tiled & morton are opt-in: slower than linear in BenchLayout and need a copy on upload
+  int attachmentLayout = Layout_Linear;
+  int textureLayout = Layout_Linear;
+
+  // huge pages for large buffers (HugePageMode), env SOFTGL_HUGE_PAGES overrides
+  int hugePages = HugePage_TRANSPARENT;
 };
 
 }
@@ -11,6 +11,7 @@
 #include "json11.hpp"
 #include "Base/Logger.h"
 #include "Base/FileUtils.h"
+#include "Base/ThreadPool.h"
 
 namespace SoftGL {
 namespace View {
@@ -94,10 +95,55 @@ void ConfigPanel::drawSettings() {
     }
   }
 
+  // shading cost heatmap
+  if (config_.rendererType == Renderer_SOFT) {
+    const char *shadingCostItems[] = {
+        "NONE",
+        "invocations",
+        "cycles",
+    };
+    ImGui::Separator();
+    ImGui::Text("shading cost:");
+    ImGui::SameLine();
+    if (config_.shadingCostMode != 0 && ImGui::SmallButton("dump")) {
+      if (shadingCostDumpFunc_) {
+        shadingCostDumpFunc_();
+      }
+    }
+    ImGui::Combo("##shading cost", &config_.shadingCostMode, shadingCostItems, 3);
+
+    // coarse shading rate
+    const char *shadingRateItems[] = {
+        "1x1",
+        "1x2",
+        "2x1",
+        "2x2",
+    };
+    ImGui::Text("shading rate:");
+    ImGui::Combo("##shading rate", &config_.shadingRate, shadingRateItems, 4);
+
+    // dynamic resolution
+    ImGui::Checkbox("dynamic resolution", &config_.dynamicResolution);
+    if (config_.dynamicResolution) {
+      ImGui::SliderFloat("budget (ms)", &config_.frameTimeBudget, 5.f, 100.f, "%.1f");
+      ImGui::DragFloatRange2("scale", &config_.minResolutionScale, &config_.maxResolutionScale,
+                             0.01f, 0.25f, 1.f, "min: %.2f", "max: %.2f");
+    }
+
+    // thread settings of Config are applied at startup only
+    ImGui::Text("threads: %zu (restart to apply config)", ThreadPool::shared().getThreadCnt());
+  }
+
   // fps
   ImGui::Separator();
   ImGui::Text("fps: %.1f (%.2f ms/frame)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
   ImGui::Text("triangles: %zu", config_.triangleCount_);
+  ImGui::Text("redraw area: %.1f%%", config_.redrawRatio_ * 100.f);
+  ImGui::Text("frame skip: %.1f%%", config_.frameSkipRate_ * 100.f);
+  ImGui::Text("resolution scale: %.2f", config_.resolutionScale_);
+
+  // pipeline statistics
+  drawStatistics();
 
   // model
   ImGui::Separator();
@@ -183,6 +229,12 @@ void ConfigPanel::drawSettings() {
   ImGui::Separator();
   ImGui::Checkbox("depth test", &config_.depthTest);
 
+  // partial redraw
+  ImGui::Separator();
+  ImGui::Checkbox("partial redraw", &config_.partialRedraw);
+  ImGui::Checkbox("frame cache", &config_.frameCache);
+  ImGui::Checkbox("occlusion cull", &config_.occlusionCull);
+
   // reverse z
   ImGui::Separator();
   if (ImGui::Checkbox("reverse z", &config_.reverseZ)) {
@@ -207,6 +259,65 @@ void ConfigPanel::drawSettings() {
   }
 }
 
+void ConfigPanel::drawStatistics() {
+  if (!config_.frameStatsValid_ || statsHistory_.empty()) {
+    return;
+  }
+  if (!ImGui::CollapsingHeader("pipeline statistics")) {
+    return;
+  }
+
+  char overlay[64];
+  for (auto &kv : statsHistory_) {
+    auto &history = kv.second;
+    snprintf(overlay, sizeof(overlay), "%s: %.0f", kv.first, history.last());
+    ImGui::PlotLines(kv.first, history.values(), STATS_HISTORY_SIZE, history.offset(), overlay,
+                     0.f, FLT_MAX, ImVec2(0, 32));
+  }
+}
+
+void ConfigPanel::updateStatistics() {
+  if (!config_.frameStatsValid_) {
+    return;
+  }
+
+  auto &stats = config_.frameStats_;
+  const uint64_t values[] = {
+      stats.drawCalls,
+      stats.vertexShaderInvocations,
+      stats.clippingInvocations,
+      stats.clippingPrimitives,
+      stats.culledPrimitives,
+      stats.primitivesEmitted,
+      stats.quadsTested,
+      stats.quadsEarlyZKilled,
+      stats.fragmentShaderInvocations,
+      stats.samplesWritten,
+      stats.helperPixels,
+  };
+  if (statsHistory_.empty()) {
+    const char *names[] = {
+        "draw calls",
+        "vs invocations",
+        "clip invocations",
+        "clip primitives",
+        "culled primitives",
+        "emitted primitives",
+        "quads tested",
+        "quads early-z killed",
+        "fs invocations",
+        "samples written",
+        "helper pixels",
+    };
+    for (auto &name : names) {
+      statsHistory_.emplace_back(name, StatsHistory());
+    }
+  }
+  for (size_t i = 0; i < statsHistory_.size(); i++) {
+    statsHistory_[i].second.push((float) values[i]);
+  }
+}
+
 void ConfigPanel::destroy() {
   ImGui_ImplOpenGL3_Shutdown();
   ImGui_ImplGlfw_Shutdown();
@@ -214,6 +325,9 @@ void ConfigPanel::destroy() {
 }
 
 void ConfigPanel::update() {
+  // record statistics of last frame
+  updateStatistics();
+
   // update light position
   config_.pointLightPosition = 2.f * glm::vec3(glm::sin(lightPositionAngle_),
                                                1.2f,
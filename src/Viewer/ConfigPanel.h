@@ -14,6 +14,26 @@
 namespace SoftGL {
 namespace View {
 
+#define STATS_HISTORY_SIZE 120
+
+class StatsHistory {
+ public:
+  void push(float value) {
+    values_[offset_] = value;
+    offset_ = (offset_ + 1) % STATS_HISTORY_SIZE;
+    last_ = value;
+  }
+
+  inline const float *values() const { return values_; }
+  inline int offset() const { return offset_; }
+  inline float last() const { return last_; }
+
+ private:
+  float values_[STATS_HISTORY_SIZE] = {0.f};
+  int offset_ = 0;
+  float last_ = 0.f;
+};
+
 class ConfigPanel {
  public:
   explicit ConfigPanel(Config &config) : config_(config) {}
@@ -49,6 +69,9 @@ class ConfigPanel {
   inline void setFrameDumpFunc(const std::function<void(void)> &func) {
     frameDumpFunc_ = func;
   }
+  inline void setShadingCostDumpFunc(const std::function<void(void)> &func) {
+    shadingCostDumpFunc_ = func;
+  }
 
  private:
   bool loadConfig();
@@ -57,6 +80,8 @@ class ConfigPanel {
   bool reloadSkybox(const std::string &name);
 
   void drawSettings();
+  void drawStatistics();
+  void updateStatistics();
   void destroy();
 
  private:
@@ -67,6 +92,8 @@ class ConfigPanel {
 
   float lightPositionAngle_ = glm::radians(235.f);
 
+  std::vector<std::pair<const char *, StatsHistory>> statsHistory_;
+
   std::unordered_map<std::string, std::string> modelPaths_;
   std::unordered_map<std::string, std::string> skyboxPaths_;
 
@@ -80,6 +107,7 @@ class ConfigPanel {
   std::function<void(void)> resetMipmapsFunc_;
   std::function<void(void)> resetReverseZFunc_;
   std::function<void(void)> frameDumpFunc_;
+  std::function<void(void)> shadingCostDumpFunc_;
 };
 
 }
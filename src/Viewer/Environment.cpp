@@ -195,7 +195,8 @@ void IBLGenerator::drawCubeFaces(CubeRenderContext &ctx, uint32_t width, uint32_
 }
 
 std::string IBLGenerator::getTextureHashKey(std::shared_ptr<Texture> &tex) {
-  return HashUtils::getHashMD5(tex->tag + std::to_string(tex->width) + std::to_string(tex->height));
+  return HashUtils::getHashMD5(tex->tag + std::to_string(tex->width) + std::to_string(tex->height)
+                                   + std::to_string(tex->format));
 }
 
 std::string IBLGenerator::getCacheFilePath(const std::string &hashKey) {
@@ -213,12 +214,15 @@ bool IBLGenerator::loadFromCache(std::shared_ptr<Texture> &tex) {
   if (!FileUtils::exists(cacheFilePath)) {
     return false;
   }
-  if (tex->format == TextureFormat_RGBA8) {
-    auto *texSoft = dynamic_cast<TextureSoft<RGBA> *>(tex.get());
-    return texSoft->loadFromFile(cacheFilePath.c_str());
-  } else {
-    auto *texSoft = dynamic_cast<TextureSoft<float> *>(tex.get());
-    return texSoft->loadFromFile(cacheFilePath.c_str());
+  switch (tex->format) {
+    case TextureFormat_RGBA8:
+      return dynamic_cast<TextureSoft<RGBA> *>(tex.get())->loadFromFile(cacheFilePath.c_str());
+    case TextureFormat_RGBA16F:
+      return dynamic_cast<TextureSoft<RGBA16F> *>(tex.get())->loadFromFile(cacheFilePath.c_str());
+    case TextureFormat_RGBA32F:
+      return dynamic_cast<TextureSoft<RGBA32F> *>(tex.get())->loadFromFile(cacheFilePath.c_str());
+    default:
+      return dynamic_cast<TextureSoft<float> *>(tex.get())->loadFromFile(cacheFilePath.c_str());
   }
 }
 
@@ -230,12 +234,19 @@ void IBLGenerator::storeToCache(std::shared_ptr<Texture> &tex) {
 
   // TODO check md5
   auto cacheFilePath = getCacheFilePath(getTextureHashKey(tex));
-  if (tex->format == TextureFormat_RGBA8) {
-    auto *texSoft = dynamic_cast<TextureSoft<RGBA> *>(tex.get());
-    texSoft->storeToFile(cacheFilePath.c_str());
-  } else {
-    auto *texSoft = dynamic_cast<TextureSoft<float> *>(tex.get());
-    texSoft->storeToFile(cacheFilePath.c_str());
+  switch (tex->format) {
+    case TextureFormat_RGBA8:
+      dynamic_cast<TextureSoft<RGBA> *>(tex.get())->storeToFile(cacheFilePath.c_str());
+      break;
+    case TextureFormat_RGBA16F:
+      dynamic_cast<TextureSoft<RGBA16F> *>(tex.get())->storeToFile(cacheFilePath.c_str());
+      break;
+    case TextureFormat_RGBA32F:
+      dynamic_cast<TextureSoft<RGBA32F> *>(tex.get())->storeToFile(cacheFilePath.c_str());
+      break;
+    default:
+      dynamic_cast<TextureSoft<float> *>(tex.get())->storeToFile(cacheFilePath.c_str());
+      break;
   }
 }
 
@@ -0,0 +1,180 @@
+/*
+ * SoftGLRender
+ * @author 	: keith@robot9.me
+ *
+ */
+
+#include "FrameGraph.h"
+#include <algorithm>
+
+namespace SoftGL {
+namespace View {
+
+static bool intersects(const std::vector<FrameResource> &a, const std::vector<FrameResource> &b) {
+  for (auto &res : a) {
+    if (std::find(b.begin(), b.end(), res) != b.end()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void FrameGraph::addPass(const char *name, PassQueue queue,
+                         std::initializer_list<FrameResource> reads,
+                         std::initializer_list<FrameResource> writes,
+                         const std::function<void()> &exec) {
+  passes_.emplace_back();
+  Pass &pass = passes_.back();
+  pass.name = name;
+  pass.queue = queue;
+  pass.exec = exec;
+  for (auto &res : reads) {
+    if (res) {
+      pass.reads.push_back(res);
+    }
+  }
+  for (auto &res : writes) {
+    if (res) {
+      pass.writes.push_back(res);
+    }
+  }
+  if (queue == PassQueue_CPU) {
+    pass.group = std::unique_ptr<TaskGroup>(new TaskGroup(TaskPriority_HIGH));
+  }
+  compiled_ = false;
+}
+
+void FrameGraph::execute() {
+  if (!compiled_) {
+    compile();
+  }
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &pass : passes_) {
+      pass.launched = false;
+      pass.finished = false;
+    }
+    readyPasses_.clear();
+    collectReadyPasses(readyPasses_);
+  }
+  launchPasses(readyPasses_);
+
+  // render passes in declaration order, cpu passes they depend on are waited (calling thread helps)
+  for (auto &pass : passes_) {
+    if (pass.queue != PassQueue_RENDER) {
+      continue;
+    }
+    for (auto &dep : pass.deps) {
+      waitPass(passes_[dep]);
+    }
+    pass.exec();
+    finishPass(pass);
+  }
+
+  // remaining cpu passes
+  for (auto &pass : passes_) {
+    waitPass(pass);
+  }
+}
+
+void FrameGraph::compile() {
+  readyPasses_.reserve(passes_.size());
+  for (size_t i = 0; i < passes_.size(); i++) {
+    Pass &pass = passes_[i];
+    pass.readyPasses.clear();
+    pass.readyPasses.reserve(passes_.size());
+    pass.deps.clear();
+    for (size_t j = 0; j < i; j++) {
+      Pass &prev = passes_[j];
+      if (intersects(pass.reads, prev.writes)
+          || intersects(pass.writes, prev.writes)
+          || intersects(pass.writes, prev.reads)) {
+        pass.deps.push_back(j);
+      }
+    }
+  }
+  compiled_ = true;
+}
+
+// mutex_ held, passes are marked launched and pushed later by launchPasses
+void FrameGraph::collectReadyPasses(std::vector<Pass *> &readyPasses) {
+  for (auto &pass : passes_) {
+    if (pass.queue != PassQueue_CPU || pass.launched) {
+      continue;
+    }
+    bool ready = true;
+    for (auto &dep : pass.deps) {
+      if (!passes_[dep].finished) {
+        ready = false;
+        break;
+      }
+    }
+    if (ready) {
+      pass.launched = true;
+      readyPasses.push_back(&pass);
+    }
+  }
+}
+
+// mutex_ not held: pushTask runs the task on calling thread if all queues are full
+void FrameGraph::launchPasses(const std::vector<Pass *> &passes) {
+  for (auto *p : passes) {
+    launchPass(*p);
+  }
+}
+
+void FrameGraph::launchPass(Pass &pass) {
+  Pass *p = &pass;
+  pool_.pushTask(*p->group, [this, p](size_t threadId) {
+    p->exec();
+
+    // launch dependents from worker, cpu pass chains don't wait for render thread
+    finishPass(*p);
+  });
+}
+
+// pass.readyPasses is only touched here, by the one thread finishing the pass
+void FrameGraph::finishPass(Pass &pass) {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    pass.finished = true;
+    pass.readyPasses.clear();
+    collectReadyPasses(pass.readyPasses);
+  }
+  launchPasses(pass.readyPasses);
+}
+
+void FrameGraph::waitPass(Pass &pass) {
+  // render passes run in declaration order, dependencies of current one are done already
+  if (pass.queue != PassQueue_CPU) {
+    return;
+  }
+
+  bool launched;
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    launched = pass.launched;
+  }
+  if (!launched) {
+    for (auto &dep : pass.deps) {
+      waitPass(passes_[dep]);
+    }
+    bool launch = false;
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      if (!pass.launched) {
+        pass.launched = true;
+        launch = true;
+      }
+    }
+    if (launch) {
+      launchPass(pass);
+    }
+  }
+
+  // not helping: calling thread may pick up an unrelated long pass and delay next render pass
+  pool_.waitGroup(*pass.group, false);
+}
+
+}
+}
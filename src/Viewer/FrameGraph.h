@@ -0,0 +1,74 @@
+/*
+ * SoftGLRender
+ * @author 	: keith@robot9.me
+ *
+ */
+
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Base/ThreadPool.h"
+
+namespace SoftGL {
+namespace View {
+
+enum PassQueue {
+  PassQueue_RENDER,   // calls renderer, executed on calling thread in declaration order
+  PassQueue_CPU,      // cpu only work, executed on thread pool (high priority) once its dependencies finished
+};
+
+// any object a pass reads or writes: texture, cpu side draw list, ... nullptr is ignored
+typedef const void *FrameResource;
+
+// passes of a frame, dependencies derived from declared resources (read after write, write after write,
+// write after read of earlier passes). cpu passes run concurrently with independent render passes.
+// built once and executed every frame, rebuild only if passes or their resources changed
+class FrameGraph {
+ public:
+  explicit FrameGraph(ThreadPool &pool) : pool_(pool) {}
+
+  void addPass(const char *name, PassQueue queue,
+               std::initializer_list<FrameResource> reads,
+               std::initializer_list<FrameResource> writes,
+               const std::function<void()> &exec);
+
+  // run all passes, return after all finished. passes are kept, execute does not allocate
+  void execute();
+
+ private:
+  struct Pass {
+    std::string name;
+    PassQueue queue = PassQueue_RENDER;
+    std::vector<FrameResource> reads;
+    std::vector<FrameResource> writes;
+    std::function<void()> exec;
+
+    std::vector<size_t> deps;
+    std::vector<Pass *> readyPasses;        // passes launched by finishing this one, reserved by compile
+    bool launched = false;                  // guarded by mutex_
+    bool finished = false;                  // guarded by mutex_
+    std::unique_ptr<TaskGroup> group;       // cpu pass only
+  };
+
+  void compile();
+  void collectReadyPasses(std::vector<Pass *> &readyPasses);
+  void launchPasses(const std::vector<Pass *> &passes);
+  void launchPass(Pass &pass);
+  void finishPass(Pass &pass);
+  void waitPass(Pass &pass);
+
+ private:
+  ThreadPool &pool_;
+  std::vector<Pass> passes_;
+  std::vector<Pass *> readyPasses_;
+  bool compiled_ = false;
+  std::mutex mutex_;
+};
+
+}
+}
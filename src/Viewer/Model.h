@@ -114,6 +114,7 @@ struct DemoScene {
   ModelPoints pointLight;
   ModelMesh floor;
   ModelMesh skybox;
+  ModelMesh occlusionBox;   // unit cube proxy for occlusion query
 
   void resetStates() {
     if (model) { model->resetStates(); }
@@ -121,6 +122,7 @@ struct DemoScene {
     pointLight.resetStates();
     floor.resetStates();
     skybox.resetStates();
+    occlusionBox.resetStates();
   }
 };
 
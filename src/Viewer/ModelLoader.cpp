@@ -25,6 +25,7 @@ ModelLoader::ModelLoader(Config &config) : config_(config) {
   loadWorldAxis();
   loadLights();
   loadFloor();
+  loadOcclusionBox();
 }
 
 void ModelLoader::loadCubeMesh(ModelVertexes &mesh) {
@@ -114,6 +115,14 @@ void ModelLoader::loadFloor() {
   scene_.floor.InitVertexes();
 }
 
+void ModelLoader::loadOcclusionBox() {
+  loadCubeMesh(scene_.occlusionBox);
+  scene_.occlusionBox.material = std::make_shared<Material>();
+  scene_.occlusionBox.material->shadingModel = Shading_BaseColor;
+  scene_.occlusionBox.material->doubleSided = true;
+  scene_.occlusionBox.aabb = BoundingBox(glm::vec3(-1.f), glm::vec3(1.f));
+}
+
 bool ModelLoader::loadSkybox(const std::string &filepath) {
   if (filepath.empty()) {
     return false;
@@ -136,14 +145,15 @@ bool ModelLoader::loadSkybox(const std::string &filepath) {
   if (StringUtils::endsWith(filepath, "/")) {
     skyboxTex.resize(6);
 
-    ThreadPool pool(6);
-    pool.pushTask([&](int thread_id) { skyboxTex[0] = loadTextureFile(filepath + "right.jpg"); });
-    pool.pushTask([&](int thread_id) { skyboxTex[1] = loadTextureFile(filepath + "left.jpg"); });
-    pool.pushTask([&](int thread_id) { skyboxTex[2] = loadTextureFile(filepath + "top.jpg"); });
-    pool.pushTask([&](int thread_id) { skyboxTex[3] = loadTextureFile(filepath + "bottom.jpg"); });
-    pool.pushTask([&](int thread_id) { skyboxTex[4] = loadTextureFile(filepath + "front.jpg"); });
-    pool.pushTask([&](int thread_id) { skyboxTex[5] = loadTextureFile(filepath + "back.jpg"); });
-    pool.waitTasksFinish();
+    auto &pool = ThreadPool::shared();
+    TaskGroup group(TaskPriority_LOW);
+    pool.pushTask(group, [&](int thread_id) { skyboxTex[0] = loadTextureFile(filepath + "right.jpg"); });
+    pool.pushTask(group, [&](int thread_id) { skyboxTex[1] = loadTextureFile(filepath + "left.jpg"); });
+    pool.pushTask(group, [&](int thread_id) { skyboxTex[2] = loadTextureFile(filepath + "top.jpg"); });
+    pool.pushTask(group, [&](int thread_id) { skyboxTex[3] = loadTextureFile(filepath + "bottom.jpg"); });
+    pool.pushTask(group, [&](int thread_id) { skyboxTex[4] = loadTextureFile(filepath + "front.jpg"); });
+    pool.pushTask(group, [&](int thread_id) { skyboxTex[5] = loadTextureFile(filepath + "back.jpg"); });
+    pool.waitGroup(group);
 
     auto &texData = material->textureData[MaterialTexType_CUBE];
     texData.tag = filepath;
@@ -469,12 +479,14 @@ void ModelLoader::preloadTextureFiles(const aiScene *scene, const std::string &r
     return;
   }
 
-  ThreadPool pool(std::min(texPaths.size(), (size_t) std::thread::hardware_concurrency()));
+  auto &pool = ThreadPool::shared();
+  TaskGroup group(TaskPriority_LOW);
   for (auto &path : texPaths) {
-    pool.pushTask([&](int thread_id) {
+    pool.pushTask(group, [&](int thread_id) {
       loadTextureFile(path);
     });
   }
+  pool.waitGroup(group);
 }
 
 std::shared_ptr<Buffer<RGBA>> ModelLoader::loadTextureFile(const std::string &path) {
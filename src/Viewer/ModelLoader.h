@@ -50,6 +50,7 @@ class ModelLoader {
   void loadWorldAxis();
   void loadLights();
   void loadFloor();
+  void loadOcclusionBox();
 
   bool processNode(const aiNode *ai_node, const aiScene *ai_scene, ModelNode &outNode, glm::mat4 &transform);
   bool processMesh(const aiMesh *ai_mesh, const aiScene *ai_scene, ModelMesh &outMesh);
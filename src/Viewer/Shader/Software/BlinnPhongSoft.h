@@ -128,25 +128,10 @@ class FS : public ShaderBlinnPhong {
   const float depthBiasCoeff = 0.00025f;
   const float depthBiasMin = 0.00005f;
 
-  size_t getSamplerDerivativeOffset(BaseSampler<RGBA> *sampler) const override {
+  int getSamplerDerivativeOffset() const override {
     return offsetof(ShaderVaryings, v_texCoord);
   }
 
-  void setupSamplerDerivative() override {
-    if (def->ALBEDO_MAP) {
-      u->u_albedoMap->setLodFunc(&texLodFunc);
-    }
-    if (def->NORMAL_MAP) {
-      u->u_normalMap->setLodFunc(&texLodFunc);
-    }
-    if (def->EMISSIVE_MAP) {
-      u->u_emissiveMap->setLodFunc(&texLodFunc);
-    }
-    if (def->AO_MAP) {
-      u->u_aoMap->setLodFunc(&texLodFunc);
-    }
-  }
-
   glm::vec3 GetNormalFromMap() {
     if (def->NORMAL_MAP) {
       glm::vec3 N = glm::normalize(v->v_normal);
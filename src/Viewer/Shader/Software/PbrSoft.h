@@ -56,8 +56,8 @@ struct ShaderUniforms {
 
   Sampler2DSoft<RGBA> *u_metalRoughnessMap;
 
-  SamplerCubeSoft<RGBA> *u_irradianceMap;
-  SamplerCubeSoft<RGBA> *u_prefilterMap;
+  SamplerCubeSoft<RGBA16F> *u_irradianceMap;
+  SamplerCubeSoft<RGBA16F> *u_prefilterMap;
 };
 
 struct ShaderVaryings {
@@ -131,25 +131,10 @@ class FS : public ShaderPbrIBL {
  public:
   CREATE_SHADER_CLONE(FS)
 
-  size_t getSamplerDerivativeOffset(BaseSampler<RGBA> *sampler) const override {
+  int getSamplerDerivativeOffset() const override {
     return offsetof(ShaderVaryings, v_texCoord);
   }
 
-  void setupSamplerDerivative() override {
-    if (def->ALBEDO_MAP) {
-      u->u_albedoMap->setLodFunc(&texLodFunc);
-    }
-    if (def->NORMAL_MAP) {
-      u->u_normalMap->setLodFunc(&texLodFunc);
-    }
-    if (def->EMISSIVE_MAP) {
-      u->u_emissiveMap->setLodFunc(&texLodFunc);
-    }
-    if (def->AO_MAP) {
-      u->u_aoMap->setLodFunc(&texLodFunc);
-    }
-  }
-
   glm::vec3 GetNormalFromMap() {
     if (def->NORMAL_MAP) {
       glm::vec3 N = glm::normalize(v->v_normal);
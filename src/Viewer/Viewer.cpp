@@ -6,6 +6,8 @@
 
 #include "Viewer.h"
 #include <algorithm>
+#include <iterator>
+#include <limits>
 #include "Base/Logger.h"
 #include "Base/HashUtils.h"
 #include "Environment.h"
@@ -23,7 +25,12 @@ bool Viewer::create(int width, int height, int outTexId) {
 
   width_ = width;
   height_ = height;
+  outputWidth_ = width;
+  outputHeight_ = height;
   outTexId_ = outTexId;
+  frameTimeAvg_ = 0.f;
+  resolutionScale_ = 1.f;
+  resolutionCooldown_ = 0;
 
   // main camera
   camera_ = &cameraMain_;
@@ -51,8 +58,10 @@ bool Viewer::create(int width, int height, int outTexId) {
   uniformBlockModel_ = CREATE_UNIFORM_BLOCK(UniformsModel);
   uniformBlockMaterial_ = CREATE_UNIFORM_BLOCK(UniformsMaterial);
 
+  occlusionQuerySupported_ = (renderer_->createQuery() != nullptr);
+
   shadowPlaceholder_ = createTexture2DDefault(1, 1, TextureFormat_FLOAT32, TextureUsage_Sampler);
-  iblPlaceholder_ = createTextureCubeDefault(1, 1, TextureUsage_Sampler);
+  iblPlaceholder_ = createTextureCubeDefault(1, 1, TextureFormat_RGBA16F, TextureUsage_Sampler);
 
   return true;
 }
@@ -85,12 +94,22 @@ void Viewer::cleanup() {
   uniformBlockMaterial_ = nullptr;
   programCache_.clear();
   pipelineCache_.clear();
+  resetModelStates();
 }
 
 void Viewer::resetReverseZ() {
   texDepthShadow_ = nullptr;
 }
 
+// per mesh states are keyed by mesh address, drop them when model changed
+void Viewer::resetModelStates() {
+  occlusionStates_.clear();
+  drawRegions_.clear();
+  drawRegionCnt_ = 0;
+  lastDrawRegionCnt_ = 0;
+  lastFrameValid_ = false;
+}
+
 void Viewer::waitRenderIdle() {
   if (renderer_) {
     renderer_->waitIdle();
@@ -104,6 +123,13 @@ void Viewer::drawFrame(DemoScene &scene) {
 
   scene_ = &scene;
 
+  // render size, by frame time of last frame
+  updateResolutionScale();
+  frameTimer_.start();
+
+  // reset statistics
+  renderer_->resetFrameStatistics();
+
   // setup framebuffer
   setupMainBuffers();
   setupShadowMapBuffers();
@@ -114,30 +140,87 @@ void Viewer::drawFrame(DemoScene &scene) {
   // setup model materials
   setupScene();
 
-  // draw shadow map
-  drawShadowMap();
-
   // setup fxaa
   processFXAASetup();
 
-  // main pass
-  ClearStates clearStates{};
-  clearStates.colorFlag = true;
-  clearStates.depthFlag = config_.depthTest;
-  clearStates.clearColor = config_.clearColor;
-  clearStates.clearDepth = config_.reverseZ ? 0.f : 1.f;
+  // shadow camera
+  cameraDepth_->lookAt(config_.pointLightPosition, glm::vec3(0), glm::vec3(0, 1, 0));
+  cameraDepth_->update();
 
-  renderer_->beginRenderPass(fboMain_, clearStates);
-  renderer_->setViewPort(0, 0, width_, height_);
+  // redraw area & culling run on frame pool while shadow map rasterizing
+  setupFrameGraph();
+  frameGraph_->execute();
 
-  // draw scene
-  drawScene(false);
+  frameTimer_.stop();
+}
 
-  // end main pass
-  renderer_->endRenderPass();
+void Viewer::setupFrameGraph() {
+  bool fxaa = config_.aaType == AAType_FXAA;
+  Texture *shadowMap = config_.shadowMap ? texDepthShadow_.get() : nullptr;
+  Texture *mainColor = fxaa ? texColorFxaa_.get() : texColorMain_.get();
+  Texture *fxaaColor = fxaa ? texColorMain_.get() : nullptr;
 
-  // draw fxaa
-  processFXAADraw();
+  FrameResource key[4] = {shadowMap, mainColor, texDepthMain_.get(), fxaaColor};
+  if (frameGraph_ && std::equal(std::begin(key), std::end(key), std::begin(frameGraphKey_))) {
+    return;
+  }
+  std::copy(std::begin(key), std::end(key), std::begin(frameGraphKey_));
+
+  // passes only capture this, graph is executed by later frames
+  frameGraph_ = std::unique_ptr<FrameGraph>(new FrameGraph(ThreadPool::shared()));
+  frameGraph_->addPass("redraw area", PassQueue_CPU, {}, {&redrawArea_}, [this] {
+    updateRedrawArea();
+  });
+  if (shadowMap) {
+    frameGraph_->addPass("shadow cull", PassQueue_CPU, {}, {&shadowDrawList_}, [this] {
+      collectDrawList(*cameraDepth_, true, shadowDrawList_);
+    });
+    frameGraph_->addPass("shadow", PassQueue_RENDER, {&shadowDrawList_}, {shadowMap}, [this] {
+      drawShadowMap();
+    });
+  }
+  frameGraph_->addPass("main cull", PassQueue_CPU, {&redrawArea_}, {&mainDrawList_}, [this] {
+    collectDrawList(cameraMain_, false, mainDrawList_);
+  });
+  frameGraph_->addPass("main", PassQueue_RENDER, {&redrawArea_, &mainDrawList_, shadowMap}, {mainColor, texDepthMain_.get()}, [this] {
+    drawMainPass();
+  });
+  if (fxaa) {
+    frameGraph_->addPass("fxaa", PassQueue_RENDER, {mainColor}, {fxaaColor}, [this] {
+      processFXAADraw();
+    });
+  }
+}
+
+void Viewer::updateResolutionScale() {
+  if (!config_.dynamicResolution || !dynamicResolutionSupported()) {
+    frameTimeAvg_ = 0.f;
+    resolutionScale_ = 1.f;
+  } else {
+    float frameTime = frameTimer_.elapseMillisFloat();
+    frameTimeAvg_ = (frameTimeAvg_ <= 0.f) ? frameTime : glm::mix(frameTimeAvg_, frameTime, 0.2f);
+
+    // hysteresis: only rescale if frame time out of [0.7, 1.1] x budget, and wait some frames after rescale
+    float budget = config_.frameTimeBudget;
+    if (resolutionCooldown_ > 0) {
+      resolutionCooldown_--;
+    } else if (frameTimeAvg_ > 0.f && (frameTimeAvg_ > budget * 1.1f || frameTimeAvg_ < budget * 0.7f)) {
+      // shading cost is proportional to pixel count (scale^2), aim at 85% of budget
+      float scale = resolutionScale_ * std::sqrt(budget * 0.85f / frameTimeAvg_);
+      scale = std::round(scale * 32.f) / 32.f;
+      scale = glm::clamp(scale, config_.minResolutionScale, config_.maxResolutionScale);
+      if (scale != resolutionScale_) {
+        resolutionScale_ = scale;
+        resolutionCooldown_ = 8;
+        frameTimeAvg_ = 0.f;
+      }
+    }
+    resolutionScale_ = glm::clamp(resolutionScale_, config_.minResolutionScale, config_.maxResolutionScale);
+  }
+
+  width_ = std::max(1, (int) ((float) outputWidth_ * resolutionScale_ + 0.5f));
+  height_ = std::max(1, (int) ((float) outputHeight_ * resolutionScale_ + 0.5f));
+  config_.resolutionScale_ = resolutionScale_;
 }
 
 void Viewer::drawShadowMap() {
@@ -145,7 +228,7 @@ void Viewer::drawShadowMap() {
     return;
   }
 
-  // shadow pass
+  // shadow pass, camera updated in drawFrame
   ClearStates clearDepth{};
   clearDepth.depthFlag = true;
   clearDepth.clearDepth = config_.reverseZ ? 0.f : 1.f;
@@ -153,12 +236,10 @@ void Viewer::drawShadowMap() {
   renderer_->setViewPort(0, 0, SHADOW_MAP_WIDTH, SHADOW_MAP_HEIGHT);
 
   // set camera
-  cameraDepth_->lookAt(config_.pointLightPosition, glm::vec3(0), glm::vec3(0, 1, 0));
-  cameraDepth_->update();
   camera_ = cameraDepth_.get();
 
   // draw scene
-  drawScene(true);
+  drawScene(true, shadowDrawList_);
 
   // end shadow pass
   renderer_->endRenderPass();
@@ -167,11 +248,39 @@ void Viewer::drawShadowMap() {
   camera_ = &cameraMain_;
 }
 
+void Viewer::drawMainPass() {
+  // nothing changed, keep last frame
+  if (redrawPartial_ && redrawArea_.empty()) {
+    return;
+  }
+
+  ClearStates clearStates{};
+  clearStates.colorFlag = true;
+  clearStates.depthFlag = config_.depthTest;
+  clearStates.clearColor = config_.clearColor;
+  clearStates.clearDepth = config_.reverseZ ? 0.f : 1.f;
+
+  renderer_->beginRenderPass(fboMain_, clearStates, redrawPartial_ ? redrawArea_ : Rect2D());
+  renderer_->setViewPort(0, 0, width_, height_);
+
+  // draw scene
+  drawScene(false, mainDrawList_);
+
+  // end main pass
+  renderer_->endRenderPass();
+}
+
 void Viewer::processFXAASetup() {
   if (config_.aaType != AAType_FXAA) {
     return;
   }
 
+  // render size changed
+  if (texColorFxaa_ && (texColorFxaa_->width != width_ || texColorFxaa_->height != height_)) {
+    texColorFxaa_ = nullptr;
+    fxaaFilter_ = nullptr;
+  }
+
   if (!texColorFxaa_) {
     TextureDesc texDesc{};
     texDesc.width = width_;
@@ -181,6 +290,7 @@ void Viewer::processFXAASetup() {
     texDesc.usage = TextureUsage_Sampler | TextureUsage_AttachmentColor;
     texDesc.useMipmaps = false;
     texDesc.multiSample = false;
+    texDesc.layout = (BufferLayout) config_.attachmentLayout;
     texColorFxaa_ = renderer_->createTexture(texDesc);
 
     SamplerDesc sampler{};
@@ -237,6 +347,11 @@ void Viewer::setupScene() {
     setupSkybox(scene_->skybox);
   }
 
+  // occlusion query proxy
+  if (occlusionCullEnabled()) {
+    setupOcclusionBox(scene_->occlusionBox);
+  }
+
   // model nodes
   ModelNode &modelNode = scene_->model->rootNode;
   setupModelNodes(modelNode, config_.wireframe);
@@ -261,6 +376,16 @@ void Viewer::setupSkybox(ModelMesh &skybox) {
                 });
 }
 
+void Viewer::setupOcclusionBox(ModelMesh &box) {
+  pipelineSetup(box, Shading_BaseColor,
+                {UniformBlock_Model, UniformBlock_Scene, UniformBlock_Material},
+                [&](RenderStates &rs) -> void {
+                  // depth test only
+                  rs.colorMask = false;
+                  rs.depthMask = false;
+                });
+}
+
 void Viewer::setupMeshBaseColor(ModelMesh &mesh, bool wireframe) {
   pipelineSetup(mesh, Shading_BaseColor,
                 {UniformBlock_Model, UniformBlock_Scene, UniformBlock_Material},
@@ -290,31 +415,30 @@ void Viewer::setupModelNodes(ModelNode &node, bool wireframe) {
   }
 }
 
-void Viewer::drawScene(bool shadowPass) {
+void Viewer::drawScene(bool shadowPass, const DrawList &drawList) {
   // update scene uniform
   updateUniformScene();
   updateUniformModel(glm::mat4(1.0f), camera_->viewMatrix());
 
   // draw point light
-  if (!shadowPass && config_.showLight) {
+  if (!shadowPass && config_.showLight && checkRedrawAreaCull(scene_->pointLight)) {
     updateUniformMaterial(*scene_->pointLight.material);
     pipelineDraw(scene_->pointLight);
   }
 
   // draw world axis
-  if (!shadowPass && config_.worldAxis) {
+  if (!shadowPass && config_.worldAxis && checkRedrawAreaCull(scene_->worldAxis)) {
     updateUniformMaterial(*scene_->worldAxis.material);
     pipelineDraw(scene_->worldAxis);
   }
 
   // draw floor
-  if (!shadowPass && config_.showFloor) {
+  if (!shadowPass && config_.showFloor && checkRedrawAreaCull(scene_->floor)) {
     drawModelMesh(scene_->floor, shadowPass, 0.f);
   }
 
   // draw model nodes opaque
-  ModelNode &modelNode = scene_->model->rootNode;
-  drawModelNodes(modelNode, shadowPass, scene_->model->centeredTransform, Alpha_Opaque);
+  drawMeshList(drawList.opaque, shadowPass);
 
   // draw skybox
   if (!shadowPass && config_.showSkybox) {
@@ -324,32 +448,63 @@ void Viewer::drawScene(bool shadowPass) {
   }
 
   // draw model nodes blend
-  drawModelNodes(modelNode, shadowPass, scene_->model->centeredTransform, Alpha_Blend);
+  drawMeshList(drawList.blend, shadowPass);
 }
 
-void Viewer::drawModelNodes(ModelNode &node, bool shadowPass, glm::mat4 &transform, AlphaMode mode, float specular) {
-  glm::mat4 modelMatrix = transform * node.transform;
+void Viewer::drawMeshList(const std::vector<DrawItem> &items, bool shadowPass, float specular) {
+  for (size_t i = 0; i < items.size(); i++) {
+    auto &item = items[i];
+
+    // update model uniform, meshes of same node share it
+    if (i == 0 || item.modelMatrix != items[i - 1].modelMatrix) {
+      updateUniformModel(item.modelMatrix, camera_->viewMatrix());
+    }
+
+    if (!shadowPass && occlusionCullEnabled()) {
+      drawModelMeshOcclusion(*item.mesh, item.modelMatrix, specular);
+      continue;
+    }
 
-  // update model uniform
-  updateUniformModel(modelMatrix, camera_->viewMatrix());
+    drawModelMesh(*item.mesh, shadowPass, specular);
+  }
+}
+
+// cpu only, called on frame pool: must not touch renderer, uniforms or camera_
+void Viewer::collectDrawList(Camera &camera, bool shadowPass, DrawList &drawList) {
+  drawList.clear();
+  ModelNode &modelNode = scene_->model->rootNode;
+  collectDrawItems(modelNode, scene_->model->centeredTransform, camera, shadowPass, Alpha_Opaque, drawList.opaque);
+  collectDrawItems(modelNode, scene_->model->centeredTransform, camera, shadowPass, Alpha_Blend, drawList.blend);
+}
+
+void Viewer::collectDrawItems(ModelNode &node, const glm::mat4 &transform, Camera &camera, bool shadowPass,
+                              AlphaMode mode, std::vector<DrawItem> &items) {
+  glm::mat4 modelMatrix = transform * node.transform;
 
-  // draw nodes
   for (auto &mesh : node.meshes) {
     if (mesh.material->alphaMode != mode) {
       continue;
     }
 
     // frustum cull
-    if (!checkMeshFrustumCull(mesh, modelMatrix)) {
+    if (!checkMeshFrustumCull(mesh, modelMatrix, camera)) {
       return;
     }
 
-    drawModelMesh(mesh, shadowPass, specular);
+    // redraw area cull
+    if (!shadowPass && !checkRedrawAreaCull(mesh)) {
+      continue;
+    }
+
+    DrawItem item;
+    item.mesh = &mesh;
+    item.modelMatrix = modelMatrix;
+    items.push_back(item);
   }
 
-  // draw child
+  // collect child
   for (auto &childNode : node.children) {
-    drawModelNodes(childNode, shadowPass, modelMatrix, mode, specular);
+    collectDrawItems(childNode, modelMatrix, camera, shadowPass, mode, items);
   }
 }
 
@@ -371,6 +526,50 @@ void Viewer::drawModelMesh(ModelMesh &mesh, bool shadowPass, float specular) {
   pipelineDraw(mesh);
 }
 
+void Viewer::drawModelMeshOcclusion(ModelMesh &mesh, const glm::mat4 &transform, float specular) {
+  auto &state = occlusionStates_[&mesh];
+  if (!state.query) {
+    state.query = renderer_->createQuery();
+  }
+
+  // visibility of last frame, keep previous if result not ready
+  uint64_t samples = 0;
+  if (renderer_->getQueryResult(state.query, samples)) {
+    state.visible = samples > 0;
+  }
+
+  // camera inside bounding box, proxy faces may be clipped by near plane
+  BoundingBox bbox = mesh.aabb.transform(transform);
+  glm::vec3 eye = camera_->eye();
+  float margin = camera_->near();
+  bool eyeInside = glm::all(glm::greaterThanEqual(eye, bbox.min - margin))
+      && glm::all(glm::lessThanEqual(eye, bbox.max + margin));
+
+  if (state.visible || eyeInside) {
+    renderer_->beginQuery(state.query);
+    drawModelMesh(mesh, false, specular);
+    renderer_->endQuery(state.query);
+    return;
+  }
+
+  // occluded in last frame: test bounding box, draw mesh only if any sample of box passed
+  glm::vec3 center = (mesh.aabb.min + mesh.aabb.max) * 0.5f;
+  glm::vec3 extent = glm::max((mesh.aabb.max - mesh.aabb.min) * 0.5f, glm::vec3(1e-3f));
+  glm::mat4 boxMatrix = transform * glm::translate(glm::mat4(1.f), center) * glm::scale(glm::mat4(1.f), extent);
+
+  auto &box = scene_->occlusionBox;
+  updateUniformModel(boxMatrix, camera_->viewMatrix());
+  updateUniformMaterial(*box.material);
+  renderer_->beginQuery(state.query);
+  pipelineDraw(box);
+  renderer_->endQuery(state.query);
+
+  updateUniformModel(transform, camera_->viewMatrix());
+  renderer_->beginConditionalRender(state.query);
+  drawModelMesh(mesh, false, specular);
+  renderer_->endConditionalRender();
+}
+
 void Viewer::pipelineSetup(ModelBase &model, ShadingModel shading, const std::set<int> &uniformBlocks,
                            const std::function<void(RenderStates &rs)> &extraStates) {
   setupVertexArray(model);
@@ -434,6 +633,7 @@ void Viewer::setupShadowMapBuffers() {
     texDesc.usage = TextureUsage_Sampler | TextureUsage_AttachmentDepth;
     texDesc.useMipmaps = false;
     texDesc.multiSample = false;
+    texDesc.layout = (BufferLayout) config_.attachmentLayout;
     texDepthShadow_ = renderer_->createTexture(texDesc);
 
     SamplerDesc sampler{};
@@ -454,7 +654,8 @@ void Viewer::setupShadowMapBuffers() {
 }
 
 void Viewer::setupMainColorBuffer(bool multiSample) {
-  if (!texColorMain_ || texColorMain_->multiSample != multiSample) {
+  if (!texColorMain_ || texColorMain_->multiSample != multiSample
+      || texColorMain_->width != width_ || texColorMain_->height != height_) {
     TextureDesc texDesc{};
     texDesc.width = width_;
     texDesc.height = height_;
@@ -463,6 +664,7 @@ void Viewer::setupMainColorBuffer(bool multiSample) {
     texDesc.usage = TextureUsage_AttachmentColor | TextureUsage_RendererOutput;
     texDesc.useMipmaps = false;
     texDesc.multiSample = multiSample;
+    texDesc.layout = (BufferLayout) config_.attachmentLayout;
     texColorMain_ = renderer_->createTexture(texDesc);
 
     SamplerDesc sampler{};
@@ -475,7 +677,8 @@ void Viewer::setupMainColorBuffer(bool multiSample) {
 }
 
 void Viewer::setupMainDepthBuffer(bool multiSample) {
-  if (!texDepthMain_ || texDepthMain_->multiSample != multiSample) {
+  if (!texDepthMain_ || texDepthMain_->multiSample != multiSample
+      || texDepthMain_->width != width_ || texDepthMain_->height != height_) {
     TextureDesc texDesc{};
     texDesc.width = width_;
     texDesc.height = height_;
@@ -484,6 +687,7 @@ void Viewer::setupMainDepthBuffer(bool multiSample) {
     texDesc.usage = TextureUsage_AttachmentDepth;
     texDesc.useMipmaps = false;
     texDesc.multiSample = multiSample;
+    texDesc.layout = (BufferLayout) config_.attachmentLayout;
     texDepthMain_ = renderer_->createTexture(texDesc);
 
     SamplerDesc sampler{};
@@ -510,6 +714,7 @@ void Viewer::setupTextures(Material &material) {
     texDesc.usage = TextureUsage_Sampler | TextureUsage_UploadData;
     texDesc.useMipmaps = false;
     texDesc.multiSample = false;
+    texDesc.layout = (BufferLayout) config_.textureLayout;
 
     SamplerDesc sampler{};
     sampler.wrapS = kv.second.wrapModeU;
@@ -609,6 +814,7 @@ void Viewer::setupPipelineStates(ModelBase &model, const std::function<void(Rend
   rs.polygonMode = PolygonMode_FILL;
 
   rs.lineWidth = material.lineWidth;
+  rs.shadingRate = (ShadingRate) config_.shadingRate;
 
   if (extraStates) {
     extraStates(rs);
@@ -742,7 +948,8 @@ bool Viewer::initSkyboxIBL() {
     if (texEqIt != skybox.material->textures.end()) {
       auto tex2d = std::dynamic_pointer_cast<Texture>(texEqIt->second);
       auto cubeSize = std::min(tex2d->width, tex2d->height);
-      auto texCvt = createTextureCubeDefault(cubeSize, cubeSize, TextureUsage_AttachmentColor | TextureUsage_Sampler);
+      auto texCvt = createTextureCubeDefault(cubeSize, cubeSize, TextureFormat_RGBA8,
+                                             TextureUsage_AttachmentColor | TextureUsage_Sampler);
       auto success = iblGenerator_->convertEquirectangular([&](ShaderProgram &program) -> bool {
                                                              return loadShaders(program, Shading_Skybox);
                                                            },
@@ -770,9 +977,12 @@ bool Viewer::initSkyboxIBL() {
     return false;
   }
 
+  // irradiance & prefilter maps are half float, keep hdr range and low intensity precision of convolution
+
   // generate irradiance map
   LOGD("generate ibl irradiance map ...");
-  auto texIrradiance = createTextureCubeDefault(kIrradianceMapSize, kIrradianceMapSize, TextureUsage_AttachmentColor | TextureUsage_Sampler);
+  auto texIrradiance = createTextureCubeDefault(kIrradianceMapSize, kIrradianceMapSize, TextureFormat_RGBA16F,
+                                                TextureUsage_AttachmentColor | TextureUsage_Sampler);
   if (iblGenerator_->generateIrradianceMap([&](ShaderProgram &program) -> bool {
                                              return loadShaders(program, Shading_IBL_Irradiance);
                                            },
@@ -787,7 +997,8 @@ bool Viewer::initSkyboxIBL() {
 
   // generate prefilter map
   LOGD("generate ibl prefilter map ...");
-  auto texPrefilter = createTextureCubeDefault(kPrefilterMapSize, kPrefilterMapSize, TextureUsage_AttachmentColor | TextureUsage_Sampler, true);
+  auto texPrefilter = createTextureCubeDefault(kPrefilterMapSize, kPrefilterMapSize, TextureFormat_RGBA16F,
+                                               TextureUsage_AttachmentColor | TextureUsage_Sampler, true);
   if (iblGenerator_->generatePrefilterMap([&](ShaderProgram &program) -> bool {
                                             return loadShaders(program, Shading_IBL_Prefilter);
                                           },
@@ -845,12 +1056,13 @@ void Viewer::updateShadowTextures(MaterialObject *materialObj, bool shadowPass)
   }
 }
 
-std::shared_ptr<Texture> Viewer::createTextureCubeDefault(int width, int height, uint32_t usage, bool mipmaps) {
+std::shared_ptr<Texture> Viewer::createTextureCubeDefault(int width, int height, TextureFormat format, uint32_t usage,
+                                                          bool mipmaps) {
   TextureDesc texDesc{};
   texDesc.width = width;
   texDesc.height = height;
   texDesc.type = TextureType_CUBE;
-  texDesc.format = TextureFormat_RGBA8;
+  texDesc.format = format;
   texDesc.usage = usage;
   texDesc.useMipmaps = mipmaps;
   texDesc.multiSample = false;
@@ -924,6 +1136,7 @@ size_t Viewer::getPipelineCacheKey(Material &material, const RenderStates &rs) {
   HashUtils::hashCombine(seed, (int) rs.blendParams.blendFuncAlpha);
   HashUtils::hashCombine(seed, (int) rs.blendParams.blendSrcAlpha);
   HashUtils::hashCombine(seed, (int) rs.blendParams.blendDstAlpha);
+  HashUtils::hashCombine(seed, rs.colorMask);
 
   HashUtils::hashCombine(seed, rs.depthTest);
   HashUtils::hashCombine(seed, rs.depthMask);
@@ -934,13 +1147,234 @@ size_t Viewer::getPipelineCacheKey(Material &material, const RenderStates &rs) {
   HashUtils::hashCombine(seed, (int) rs.polygonMode);
 
   HashUtils::hashCombine(seed, rs.lineWidth);
+  HashUtils::hashCombine(seed, (int) rs.shadingRate);
+
+  HashUtils::hashCombine(seed, rs.scissorTest);
+  HashUtils::hashCombine(seed, rs.scissor.x);
+  HashUtils::hashCombine(seed, rs.scissor.y);
+  HashUtils::hashCombine(seed, rs.scissor.width);
+  HashUtils::hashCombine(seed, rs.scissor.height);
 
   return seed;
 }
 
-bool Viewer::checkMeshFrustumCull(ModelMesh &mesh, const glm::mat4 &transform) {
+bool Viewer::checkMeshFrustumCull(ModelMesh &mesh, const glm::mat4 &transform, Camera &camera) {
   BoundingBox bbox = mesh.aabb.transform(transform);
-  return camera_->getFrustum().intersects(bbox);
+  return camera.getFrustum().intersects(bbox);
+}
+
+void Viewer::updateRedrawArea() {
+  // entries of last frame are updated in place, no map node allocated for drawables seen before
+  drawRegionFrame_++;
+  lastDrawRegionCnt_ = drawRegionCnt_;
+  drawRegionCnt_ = 0;
+
+  if (config_.showLight) {
+    addDrawRegion(scene_->pointLight, glm::mat4(1.0f), false);
+  }
+  if (config_.worldAxis) {
+    addDrawRegion(scene_->worldAxis, glm::mat4(1.0f), false);
+  }
+  if (config_.showFloor) {
+    addDrawRegion(scene_->floor, glm::mat4(1.0f), false);
+  }
+  collectDrawRegions(scene_->model->rootNode, scene_->model->centeredTransform);
+
+  Rect2D fullRect;
+  fullRect.width = width_;
+  fullRect.height = height_;
+
+  size_t frameHash = getFrameStateHash();
+  bool partial = config_.partialRedraw
+      && partialRedrawSupported()
+      && lastFrameValid_
+      && frameHash == lastFrameHash_
+      && drawRegionCnt_ == lastDrawRegionCnt_;
+  lastFrameHash_ = frameHash;
+  lastFrameValid_ = true;
+
+  Rect2D dirty;
+  if (partial) {
+    for (auto &it : drawRegions_) {
+      auto &state = it.second;
+      if (state.frame != drawRegionFrame_) {
+        continue;
+      }
+      if (state.lastFrame != drawRegionFrame_ - 1) {
+        partial = false;
+        break;
+      }
+      if (state.lastRegion.stateHash == state.region.stateHash) {
+        continue;
+      }
+      // shadow may fall anywhere on screen
+      if (config_.shadowMap && state.lastRegion.shadowHash != state.region.shadowHash) {
+        partial = false;
+        break;
+      }
+      dirty = dirty.merge(state.lastRegion.rect).merge(state.region.rect);
+    }
+  }
+
+  redrawPartial_ = partial;
+  redrawArea_ = partial ? dirty.intersect(fullRect) : fullRect;
+  config_.redrawRatio_ = fullRect.empty() ? 0.f :
+                         (float) redrawArea_.width * (float) redrawArea_.height / ((float) width_ * (float) height_);
+}
+
+size_t Viewer::getFrameStateHash() {
+  size_t seed = 0;
+
+  // camera
+  HashUtils::hashCombineMurmur(seed, cameraMain_.viewMatrix());
+  HashUtils::hashCombineMurmur(seed, cameraMain_.projectionMatrix());
+  HashUtils::hashCombine(seed, width_);
+  HashUtils::hashCombine(seed, height_);
+
+  // render targets
+  HashUtils::hashCombine(seed, texColorMain_.get());
+  HashUtils::hashCombine(seed, texDepthMain_.get());
+  HashUtils::hashCombine(seed, scene_->model.get());
+
+  // skybox reload replaces material, ibl maps generated later light all pbr meshes
+  HashUtils::hashCombine(seed, scene_->skybox.material.get());
+  HashUtils::hashCombine(seed, iBLEnabled());
+
+  // config
+  HashUtils::hashCombine(seed, config_.wireframe);
+  HashUtils::hashCombine(seed, config_.worldAxis);
+  HashUtils::hashCombine(seed, config_.showLight);
+  HashUtils::hashCombine(seed, config_.showSkybox);
+  HashUtils::hashCombine(seed, config_.showFloor);
+  HashUtils::hashCombine(seed, config_.shadowMap);
+  HashUtils::hashCombine(seed, config_.pbrIbl);
+  HashUtils::hashCombine(seed, config_.mipmaps);
+  HashUtils::hashCombine(seed, config_.cullFace);
+  HashUtils::hashCombine(seed, config_.depthTest);
+  HashUtils::hashCombine(seed, config_.reverseZ);
+  HashUtils::hashCombine(seed, config_.aaType);
+  HashUtils::hashCombine(seed, config_.shadingCostMode);
+  HashUtils::hashCombine(seed, config_.shadingRate);
+  HashUtils::hashCombineMurmur(seed, config_.clearColor);
+  HashUtils::hashCombineMurmur(seed, config_.ambientColor);
+
+  // point light affects all lit pixels
+  if (!config_.wireframe) {
+    HashUtils::hashCombineMurmur(seed, config_.pointLightPosition);
+    HashUtils::hashCombineMurmur(seed, config_.pointLightColor);
+  }
+
+  return seed;
+}
+
+void Viewer::collectDrawRegions(ModelNode &node, const glm::mat4 &transform) {
+  glm::mat4 modelMatrix = transform * node.transform;
+  for (auto &mesh : node.meshes) {
+    addDrawRegion(mesh, modelMatrix, true);
+  }
+  for (auto &childNode : node.children) {
+    collectDrawRegions(childNode, modelMatrix);
+  }
+}
+
+void Viewer::addDrawRegion(ModelBase &model, const glm::mat4 &transform, bool shadowCaster) {
+  auto &material = *model.material;
+
+  size_t geometry = 0;
+  HashUtils::hashCombineMurmur(geometry, transform);
+  HashUtils::hashCombine(geometry, model.vao.get());
+  if (model.primitiveType != Primitive_TRIANGLE) {
+    for (auto &v : model.vertexes) {
+      HashUtils::hashCombineMurmur(geometry, v.a_position);
+    }
+  }
+
+  DrawRegion region;
+  region.stateHash = geometry;
+  HashUtils::hashCombine(region.stateHash, material.materialObj.get());
+  HashUtils::hashCombine(region.stateHash, (int) material.shadingModel);
+  HashUtils::hashCombine(region.stateHash, (int) material.alphaMode);
+  HashUtils::hashCombine(region.stateHash, material.doubleSided);
+  HashUtils::hashCombineMurmur(region.stateHash, material.baseColor);
+  HashUtils::hashCombine(region.stateHash, material.pointSize);
+  HashUtils::hashCombine(region.stateHash, material.lineWidth);
+  region.shadowHash = shadowCaster ? geometry : 0;
+  region.rect = getScreenRect(model, transform);
+
+  auto &state = drawRegions_[&model];
+  if (state.frame != drawRegionFrame_) {
+    state.lastRegion = state.region;
+    state.lastFrame = state.frame;
+    state.frame = drawRegionFrame_;
+    drawRegionCnt_++;
+  }
+  state.region = region;
+}
+
+Rect2D Viewer::getScreenRect(ModelBase &model, const glm::mat4 &transform) {
+  Rect2D fullRect;
+  fullRect.width = width_;
+  fullRect.height = height_;
+
+  glm::mat4 mvp = cameraMain_.projectionMatrix() * cameraMain_.viewMatrix() * transform;
+  glm::vec2 minPos(std::numeric_limits<float>::max());
+  glm::vec2 maxPos(std::numeric_limits<float>::lowest());
+  auto expand = [&](const glm::vec3 &p) -> bool {
+    glm::vec4 clip = mvp * glm::vec4(p, 1.f);
+    // crossing near plane
+    if (clip.w <= 0.f) {
+      return false;
+    }
+    glm::vec2 screen = (glm::vec2(clip) / clip.w * 0.5f + 0.5f) * glm::vec2(width_, height_);
+    minPos = glm::min(minPos, screen);
+    maxPos = glm::max(maxPos, screen);
+    return true;
+  };
+
+  if (model.primitiveType == Primitive_TRIANGLE) {
+    auto &bbox = model.aabb;
+    glm::vec3 corners[8];
+    for (int i = 0; i < 8; i++) {
+      corners[i] = glm::vec3((i & 1) ? bbox.max.x : bbox.min.x,
+                             (i & 2) ? bbox.max.y : bbox.min.y,
+                             (i & 4) ? bbox.max.z : bbox.min.z);
+      if (!expand(corners[i])) {
+        return fullRect;
+      }
+    }
+  } else {
+    for (auto &v : model.vertexes) {
+      if (!expand(v.a_position)) {
+        return fullRect;
+      }
+    }
+  }
+
+  // points size, line width and rasterization rounding
+  float margin = std::max(model.material->pointSize, model.material->lineWidth) * 0.5f + 2.f;
+  minPos = glm::max(minPos - margin, glm::vec2(-1.f));
+  maxPos = glm::min(maxPos + margin, glm::vec2(width_ + 1, height_ + 1));
+  if (minPos.x >= maxPos.x || minPos.y >= maxPos.y) {
+    return {};
+  }
+
+  Rect2D rect;
+  rect.x = (int) std::floor(minPos.x);
+  rect.y = (int) std::floor(minPos.y);
+  rect.width = (int) std::ceil(maxPos.x) - rect.x;
+  rect.height = (int) std::ceil(maxPos.y) - rect.y;
+  return rect.intersect(fullRect);
+}
+
+bool Viewer::checkRedrawAreaCull(ModelBase &model) {
+  if (!redrawPartial_) {
+    return true;
+  }
+  auto it = drawRegions_.find(&model);
+  if (it == drawRegions_.end() || it->second.frame != drawRegionFrame_) {
+    return true;
+  }
+  return !it->second.region.rect.intersect(redrawArea_).empty();
 }
 
 }
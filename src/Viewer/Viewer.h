@@ -7,16 +7,55 @@
 #pragma once
 
 #include "Base/GLMInc.h"
+#include "Base/Timer.h"
 #include "Render/Renderer.h"
 #include "Model.h"
 #include "Config.h"
 #include "Camera.h"
 #include "QuadFilter.h"
 #include "Environment.h"
+#include "FrameGraph.h"
 
 namespace SoftGL {
 namespace View {
 
+// screen region of a drawable in main pass, used by partial redraw
+struct DrawRegion {
+  size_t stateHash = 0;
+  size_t shadowHash = 0;  // 0 if not a shadow caster
+  Rect2D rect;
+};
+
+// regions of a drawable in current & last frame, entry kept across frames
+struct DrawRegionState {
+  DrawRegion region;
+  DrawRegion lastRegion;
+  size_t frame = 0;       // frame of region
+  size_t lastFrame = 0;   // frame of lastRegion, 0 if none
+};
+
+// mesh to draw in a pass, collected by cull pass
+struct DrawItem {
+  ModelMesh *mesh = nullptr;
+  glm::mat4 modelMatrix;
+};
+
+struct DrawList {
+  std::vector<DrawItem> opaque;
+  std::vector<DrawItem> blend;
+
+  inline void clear() {
+    opaque.clear();
+    blend.clear();
+  }
+};
+
+// occlusion query of last frame
+struct OcclusionState {
+  std::shared_ptr<QueryObject> query;
+  bool visible = true;
+};
+
 class Viewer {
  public:
   Viewer(Config &config, Camera &camera) : config_(config), cameraMain_(camera) {}
@@ -30,18 +69,36 @@ class Viewer {
 
   void waitRenderIdle();
   void resetReverseZ();
+  void resetModelStates();
+
+  inline const PipelineStatistics *getFrameStatistics() {
+    return renderer_ ? renderer_->getFrameStatistics() : nullptr;
+  }
 
   // used by RenderDoc to capture frames
   virtual void *getDevicePointer() { return nullptr; }
 
+  // shading cost heatmap, software renderer only
+  virtual void dumpShadingCost(const char *path) {}
+
  protected:
   virtual std::shared_ptr<Renderer> createRenderer() = 0;
   virtual bool loadShaders(ShaderProgram &program, ShadingModel shading) = 0;
+  virtual void setupMainBuffers();
+
+  // keep last frame color & depth outside redraw area
+  virtual bool partialRedrawSupported() { return true; }
+
+  // render at scaled resolution, swapBuffer need upscale to output size
+  virtual bool dynamicResolutionSupported() { return false; }
+  void updateResolutionScale();
 
  private:
   void cleanup();
 
+  void setupFrameGraph();
   void drawShadowMap();
+  void drawMainPass();
 
   void processFXAASetup();
   void processFXAADraw();
@@ -53,16 +110,20 @@ class Viewer {
   void setupMeshTextured(ModelMesh &mesh);
   void setupModelNodes(ModelNode &node, bool wireframe);
   void setupSkybox(ModelMesh &skybox);
+  void setupOcclusionBox(ModelMesh &box);
 
-  void drawScene(bool shadowPass);
-  void drawModelNodes(ModelNode &node, bool shadowPass, glm::mat4 &transform, AlphaMode mode, float specular = 1.f);
+  void drawScene(bool shadowPass, const DrawList &drawList);
+  void drawMeshList(const std::vector<DrawItem> &items, bool shadowPass, float specular = 1.f);
+  void collectDrawList(Camera &camera, bool shadowPass, DrawList &drawList);
+  void collectDrawItems(ModelNode &node, const glm::mat4 &transform, Camera &camera, bool shadowPass, AlphaMode mode,
+                        std::vector<DrawItem> &items);
   void drawModelMesh(ModelMesh &mesh, bool shadowPass, float specular);
+  void drawModelMeshOcclusion(ModelMesh &mesh, const glm::mat4 &transform, float specular);
 
   void pipelineSetup(ModelBase &model, ShadingModel shading, const std::set<int> &uniformBlocks,
                      const std::function<void(RenderStates &rs)> &extraStates = nullptr);
   void pipelineDraw(ModelBase &model);
 
-  void setupMainBuffers();
   void setupShadowMapBuffers();
   void setupMainColorBuffer(bool multiSample);
   void setupMainDepthBuffer(bool multiSample);
@@ -89,9 +150,20 @@ class Viewer {
   static size_t getShaderProgramCacheKey(ShadingModel shading, const std::set<std::string> &defines);
   static size_t getPipelineCacheKey(Material &material, const RenderStates &rs);
 
-  std::shared_ptr<Texture> createTextureCubeDefault(int width, int height, uint32_t usage, bool mipmaps = false);
+  std::shared_ptr<Texture> createTextureCubeDefault(int width, int height, TextureFormat format, uint32_t usage, bool mipmaps = false);
   std::shared_ptr<Texture> createTexture2DDefault(int width, int height, TextureFormat format, uint32_t usage, bool mipmaps = false);
-  bool checkMeshFrustumCull(ModelMesh &mesh, const glm::mat4 &transform);
+  static bool checkMeshFrustumCull(ModelMesh &mesh, const glm::mat4 &transform, Camera &camera);
+
+  void updateRedrawArea();
+  size_t getFrameStateHash();
+  void collectDrawRegions(ModelNode &node, const glm::mat4 &transform);
+  void addDrawRegion(ModelBase &model, const glm::mat4 &transform, bool shadowCaster);
+  Rect2D getScreenRect(ModelBase &model, const glm::mat4 &transform);
+  bool checkRedrawAreaCull(ModelBase &model);
+
+  inline bool occlusionCullEnabled() const {
+    return config_.occlusionCull && occlusionQuerySupported_;
+  }
 
  protected:
   Config &config_;
@@ -102,12 +174,29 @@ class Viewer {
 
   DemoScene *scene_ = nullptr;
 
+  // render size, may be scaled from output size by dynamic resolution
   int width_ = 0;
   int height_ = 0;
+  int outputWidth_ = 0;
+  int outputHeight_ = 0;
   int outTexId_ = 0;
 
+  // dynamic resolution
+  Timer frameTimer_;
+  float frameTimeAvg_ = 0.f;
+  float resolutionScale_ = 1.f;
+  int resolutionCooldown_ = 0;
+
   std::shared_ptr<Renderer> renderer_ = nullptr;
 
+  // frame graph, rebuilt only if its passes or attachments changed
+  std::unique_ptr<FrameGraph> frameGraph_;
+  FrameResource frameGraphKey_[4] = {};
+
+  // cpu passes of frame graph (redraw area, culling)
+  DrawList mainDrawList_;
+  DrawList shadowDrawList_;
+
   // main fbo
   std::shared_ptr<FrameBuffer> fboMain_ = nullptr;
   std::shared_ptr<Texture> texColorMain_ = nullptr;
@@ -134,6 +223,20 @@ class Viewer {
   // caches
   std::unordered_map<size_t, std::shared_ptr<ShaderProgram>> programCache_;
   std::unordered_map<size_t, std::shared_ptr<PipelineStates>> pipelineCache_;
+
+  // occlusion cull
+  bool occlusionQuerySupported_ = false;
+  std::unordered_map<const ModelBase *, OcclusionState> occlusionStates_;
+
+  // partial redraw
+  std::unordered_map<const ModelBase *, DrawRegionState> drawRegions_;
+  size_t drawRegionFrame_ = 0;
+  size_t drawRegionCnt_ = 0;
+  size_t lastDrawRegionCnt_ = 0;
+  size_t lastFrameHash_ = 0;
+  bool lastFrameValid_ = false;
+  bool redrawPartial_ = false;
+  Rect2D redrawArea_;
 };
 
 }
@@ -14,11 +14,13 @@
 #include "ViewerOpenGL.h"
 #include "ViewerVulkan.h"
 #include "RenderDebug.h"
+#include "Base/HashUtils.h"
 
 namespace SoftGL {
 namespace View {
 
 #define RENDER_TYPE_NONE (-1)
+#define FRAME_SKIP_WINDOW 60
 
 class ViewerManager {
  public:
@@ -39,6 +41,9 @@ class ViewerManager {
     config_ = std::make_shared<Config>();
     configPanel_ = std::make_shared<ConfigPanel>(*config_);
 
+    // shared thread pool & huge pages, before model loading creates the pool
+    ViewerSoftware::configureShared(*config_);
+
     // viewer software
     auto viewer_soft = std::make_shared<ViewerSoftware>(*config_, *camera_);
     viewers_[Renderer_SOFT] = std::move(viewer_soft);
@@ -68,23 +73,35 @@ class ViewerManager {
     configPanel_->setResetMipmapsFunc([&]() -> void {
       waitRenderIdle();
       modelLoader_->getScene().model->resetStates();
+      sceneVersion_++;
     });
     configPanel_->setResetReverseZFunc([&]() -> void {
       waitRenderIdle();
       auto &viewer = viewers_[config_->rendererType];
       viewer->resetReverseZ();
+      sceneVersion_++;
     });
     configPanel_->setReloadModelFunc([&](const std::string &path) -> bool {
       waitRenderIdle();
+      for (auto &it : viewers_) {
+        it.second->resetModelStates();
+      }
+      sceneVersion_++;
       return modelLoader_->loadModel(path);
     });
     configPanel_->setReloadSkyboxFunc([&](const std::string &path) -> bool {
       waitRenderIdle();
+      sceneVersion_++;
       return modelLoader_->loadSkybox(path);
     });
     configPanel_->setFrameDumpFunc([&]() -> void {
       dumpFrame_ = true;
     });
+    configPanel_->setShadingCostDumpFunc([&]() -> void {
+      waitRenderIdle();
+      auto &viewer = viewers_[config_->rendererType];
+      viewer->dumpShadingCost("./shading_cost.png");
+    });
     configPanel_->setUpdateLightFunc([&](glm::vec3 &position, glm::vec3 &color) -> void {
       auto &scene = modelLoader_->getScene();
       scene.pointLight.vertexes[0].a_position = position;
@@ -101,6 +118,22 @@ class ViewerManager {
     // update triangle count
     config_->triangleCount_ = modelLoader_->getModelPrimitiveCnt();
 
+    // nothing changed since last frame, reuse last output
+    size_t frameHash = getFrameHash();
+    // keep drawing while resolution scaled down, so it can recover when idle
+    bool skipFrame = config_->frameCache
+        && !dumpFrame_
+        && config_->resolutionScale_ >= config_->maxResolutionScale
+        && rendererType_ == config_->rendererType
+        && frameHash == lastFrameHash_
+        && lastOutTex_ >= 0;
+    lastFrameHash_ = frameHash;
+    updateFrameSkipRate(skipFrame);
+    if (skipFrame) {
+      config_->frameStats_.reset();
+      return lastOutTex_;
+    }
+
     auto &viewer = viewers_[config_->rendererType];
     if (rendererType_ != config_->rendererType) {
       // change render type need to reset all model states
@@ -113,11 +146,76 @@ class ViewerManager {
       RenderDebugger::startFrameCapture(viewer->getDevicePointer());
     }
     viewer->drawFrame(modelLoader_->getScene());
+
+    // update pipeline statistics
+    auto *stats = viewer->getFrameStatistics();
+    config_->frameStatsValid_ = (stats != nullptr);
+    if (stats) {
+      config_->frameStats_ = *stats;
+    }
+
     if (dumpFrame_) {
       dumpFrame_ = false;
       RenderDebugger::endFrameCapture(viewer->getDevicePointer());
     }
-    return viewer->swapBuffer();
+    lastOutTex_ = viewer->swapBuffer();
+    return lastOutTex_;
+  }
+
+  size_t getFrameHash() {
+    size_t seed = 0;
+
+    // camera
+    HashUtils::hashCombineMurmur(seed, camera_->viewMatrix());
+    HashUtils::hashCombineMurmur(seed, camera_->projectionMatrix());
+    HashUtils::hashCombine(seed, width_);
+    HashUtils::hashCombine(seed, height_);
+
+    // scene
+    HashUtils::hashCombine(seed, sceneVersion_);
+    HashUtils::hashCombine(seed, modelLoader_->getScene().model.get());
+
+    // config
+    auto &config = *config_;
+    HashUtils::hashCombine(seed, config.wireframe);
+    HashUtils::hashCombine(seed, config.worldAxis);
+    HashUtils::hashCombine(seed, config.showSkybox);
+    HashUtils::hashCombine(seed, config.showFloor);
+    HashUtils::hashCombine(seed, config.shadowMap);
+    HashUtils::hashCombine(seed, config.pbrIbl);
+    HashUtils::hashCombine(seed, config.mipmaps);
+    HashUtils::hashCombine(seed, config.cullFace);
+    HashUtils::hashCombine(seed, config.depthTest);
+    HashUtils::hashCombine(seed, config.reverseZ);
+    HashUtils::hashCombine(seed, config.partialRedraw);
+    HashUtils::hashCombine(seed, config.occlusionCull);
+    HashUtils::hashCombine(seed, config.showLight);
+    HashUtils::hashCombine(seed, config.aaType);
+    HashUtils::hashCombine(seed, config.rendererType);
+    HashUtils::hashCombine(seed, config.shadingCostMode);
+    HashUtils::hashCombine(seed, config.shadingRate);
+    HashUtils::hashCombine(seed, config.dynamicResolution);
+    HashUtils::hashCombine(seed, config.frameTimeBudget);
+    HashUtils::hashCombine(seed, config.minResolutionScale);
+    HashUtils::hashCombine(seed, config.maxResolutionScale);
+    HashUtils::hashCombineMurmur(seed, config.clearColor);
+    HashUtils::hashCombineMurmur(seed, config.ambientColor);
+    HashUtils::hashCombineMurmur(seed, config.pointLightPosition);
+    HashUtils::hashCombineMurmur(seed, config.pointLightColor);
+
+    return seed;
+  }
+
+  void updateFrameSkipRate(bool skipped) {
+    frameCount_++;
+    if (skipped) {
+      frameSkipCount_++;
+    }
+    if (frameCount_ >= FRAME_SKIP_WINDOW) {
+      config_->frameSkipRate_ = (float) frameSkipCount_ / (float) frameCount_;
+      frameCount_ = 0;
+      frameSkipCount_ = 0;
+    }
   }
 
   inline void destroy() {
@@ -195,6 +293,13 @@ class ViewerManager {
   int rendererType_ = RENDER_TYPE_NONE;
   bool showConfigPanel_ = true;
   bool dumpFrame_ = false;
+
+  // frame cache
+  size_t sceneVersion_ = 0;
+  size_t lastFrameHash_ = 0;
+  int lastOutTex_ = -1;
+  size_t frameCount_ = 0;
+  size_t frameSkipCount_ = 0;
 };
 
 }
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "Viewer.h"
+#include "Base/Logger.h"
 #include "Render/OpenGL/OpenGLUtils.h"
 #include "Render/Software/RendererSoft.h"
 #include "Render/Software/TextureSoft.h"
@@ -22,24 +23,155 @@ class ViewerSoftware : public Viewer {
  public:
   ViewerSoftware(Config &config, Camera &camera) : Viewer(config, camera) {}
 
+  // process wide settings, call before the shared pool is first used (model loading uses it)
+  static void configureShared(const Config &config) {
+    ThreadPoolConfig poolConfig;
+    poolConfig.threadCnt = (size_t) std::max(config.threadCount, 0);
+    poolConfig.pinThreads = config.threadPinning;
+    poolConfig.numaNode = config.numaNode;
+    poolConfig.loadEnv();
+    if (!ThreadPool::configureShared(poolConfig)) {
+      LOGE("shared thread pool already created, thread settings ignored until restart");
+    }
+
+    int hugePages = config.hugePages;
+    if (const char *env = getenv("SOFTGL_HUGE_PAGES")) {
+      hugePages = atoi(env);
+    }
+    MemoryUtils::setHugePageMode((HugePageMode) hugePages);
+  }
+
   void configRenderer() override {
     camera_->setReverseZ(config_.reverseZ);
     cameraDepth_->setReverseZ(config_.reverseZ);
+
+    auto *rendererSoft = dynamic_cast<RendererSoft *>(renderer_.get());
+    if (rendererSoft) {
+      rendererSoft->setShadingCostMode((ShadingCostMode) config_.shadingCostMode);
+    }
   }
 
   int swapBuffer() override {
+    if (config_.shadingCostMode != ShadingCost_NONE && texShadingCost_) {
+      return swapShadingCost();
+    }
+
     auto *texOut = dynamic_cast<TextureSoft<RGBA> *>(texColorMain_.get());
     auto buffer = texOut->getImage().getBuffer()->buffer;
-    GL_CHECK(glBindTexture(GL_TEXTURE_2D, outTexId_));
-    GL_CHECK(glTexSubImage2D(GL_TEXTURE_2D,
-                             0,
-                             0,
-                             0,
-                             (int) buffer->getWidth(),
-                             (int) buffer->getHeight(),
-                             GL_RGBA,
-                             GL_UNSIGNED_BYTE,
-                             buffer->getRawDataPtr()));
+    if (buffer->getLayout() == Layout_Linear) {
+      return uploadOutput(buffer->getRawDataPtr(), (int) buffer->getWidth(), (int) buffer->getHeight());
+    }
+    outputPixels_.resize(buffer->getWidth() * buffer->getHeight());
+    buffer->copyLinearDataTo(outputPixels_.data());
+    return uploadOutput(outputPixels_.data(), (int) buffer->getWidth(), (int) buffer->getHeight());
+  }
+
+  void destroy() override {
+    Viewer::destroy();
+
+    if (scaledTex_) {
+      GL_CHECK(glDeleteTextures(1, &scaledTex_));
+      scaledTex_ = 0;
+    }
+    if (fboIn_) {
+      GL_CHECK(glDeleteFramebuffers(1, &fboIn_));
+      fboIn_ = 0;
+    }
+    if (fboOut_) {
+      GL_CHECK(glDeleteFramebuffers(1, &fboOut_));
+      fboOut_ = 0;
+    }
+  }
+
+  void dumpShadingCost(const char *path) override {
+    if (texShadingCost_) {
+      texShadingCost_->dumpImage(path, 0, 0, ImageDump_HEATMAP);
+    }
+  }
+
+ protected:
+  bool dynamicResolutionSupported() override { return true; }
+
+  void setupMainBuffers() override {
+    Viewer::setupMainBuffers();
+
+    if (config_.shadingCostMode == ShadingCost_NONE) {
+      texShadingCost_ = nullptr;
+      heatmapPixels_.clear();
+    } else if (!texShadingCost_ || texShadingCost_->width != width_ || texShadingCost_->height != height_) {
+      TextureDesc texDesc{};
+      texDesc.width = width_;
+      texDesc.height = height_;
+      texDesc.type = TextureType_2D;
+      texDesc.format = TextureFormat_FLOAT32;
+      texDesc.usage = TextureUsage_AttachmentColor;
+      texDesc.useMipmaps = false;
+      texDesc.multiSample = false;
+      texDesc.layout = (BufferLayout) config_.attachmentLayout;
+      texShadingCost_ = renderer_->createTexture(texDesc);
+      texShadingCost_->initImageData();
+    }
+
+    auto *fboSoft = dynamic_cast<FrameBufferSoft *>(fboMain_.get());
+    fboSoft->setShadingCostAttachment(texShadingCost_);
+  }
+
+  int swapShadingCost() {
+    auto *texCost = dynamic_cast<TextureSoft<float> *>(texShadingCost_.get());
+    auto buffer = texCost->getImage().getBuffer()->buffer;
+    auto width = (uint32_t) buffer->getWidth();
+    auto height = (uint32_t) buffer->getHeight();
+
+    heatmapPixels_.resize(width * height);
+    float *costs = buffer->getRawDataPtr();
+    if (buffer->getLayout() != Layout_Linear) {
+      costPixels_.resize(width * height);
+      buffer->copyLinearDataTo(costPixels_.data());
+      costs = costPixels_.data();
+    }
+    ImageUtils::convertHeatmapImage(heatmapPixels_.data(), costs, width, height);
+
+    return uploadOutput(heatmapPixels_.data(), (int) width, (int) height);
+  }
+
+  int uploadOutput(const void *pixels, int width, int height) {
+    if (width == outputWidth_ && height == outputHeight_) {
+      GL_CHECK(glBindTexture(GL_TEXTURE_2D, outTexId_));
+      GL_CHECK(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+      return outTexId_;
+    }
+
+    // dynamic resolution: upload to scaled texture, then upscale into output texture
+    if (!scaledTex_) {
+      GL_CHECK(glGenTextures(1, &scaledTex_));
+      GL_CHECK(glGenFramebuffers(1, &fboIn_));
+      GL_CHECK(glGenFramebuffers(1, &fboOut_));
+      scaledWidth_ = 0;
+      scaledHeight_ = 0;
+    }
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, scaledTex_));
+    if (scaledWidth_ != width || scaledHeight_ != height) {
+      scaledWidth_ = width;
+      scaledHeight_ = height;
+      GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+      GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+      GL_CHECK(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+    } else {
+      GL_CHECK(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+    }
+
+    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, fboIn_));
+    GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, scaledTex_, 0));
+    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, fboOut_));
+    GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, outTexId_, 0));
+
+    GL_CHECK(glBindFramebuffer(GL_READ_FRAMEBUFFER, fboIn_));
+    GL_CHECK(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fboOut_));
+    GL_CHECK(glBlitFramebuffer(0, 0, width, height,
+                               0, 0, outputWidth_, outputHeight_,
+                               GL_COLOR_BUFFER_BIT,
+                               GL_LINEAR));
+    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
     return outTexId_;
   }
 
@@ -67,6 +199,19 @@ class ViewerSoftware : public Viewer {
 
     return false;
   }
+
+ private:
+  std::shared_ptr<Texture> texShadingCost_ = nullptr;
+  std::vector<RGBA> heatmapPixels_;
+  std::vector<float> costPixels_;   // row order copy of tiled cost buffer
+  std::vector<RGBA> outputPixels_;  // row order copy of tiled output buffer
+
+  // dynamic resolution upscale
+  GLuint scaledTex_ = 0;
+  GLuint fboIn_ = 0;
+  GLuint fboOut_ = 0;
+  int scaledWidth_ = 0;
+  int scaledHeight_ = 0;
 };
 
 }
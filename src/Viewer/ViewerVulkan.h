@@ -24,6 +24,9 @@ class ViewerVulkan : public Viewer {
   ViewerVulkan(Config &config, Camera &camera) : Viewer(config, camera) {
   }
 
+  // render pass discards attachments content (initialLayout undefined)
+  bool partialRedrawSupported() override { return false; }
+
   void configRenderer() override {
     camera_->setReverseZ(config_.reverseZ);
     cameraDepth_->setReverseZ(config_.reverseZ);
@@ -0,0 +1,323 @@
+/*
+ * SoftGLRender
+ * @author 	: keith@robot9.me
+ *
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include "Base/MemoryUtils.h"
+#include "Render/Software/RendererSoft.h"
+#include "Viewer/Material.h"
+#include "Viewer/Shader/Software/BasicSoft.h"
+
+using namespace SoftGL;
+using namespace SoftGL::View;
+
+#define TEST_SIZE 256
+#define TEST_WARMUP_FRAMES 2
+#define TEST_FRAMES 10
+#define TEST_TEX_SIZE 64
+
+// mipmapped texture sampled with uv derivatives, as albedo map of viewer shaders
+namespace ShaderTex {
+
+struct ShaderDefines {
+};
+
+struct ShaderAttributes {
+  glm::vec3 a_position;
+};
+
+struct ShaderUniforms {
+  // UniformsTex
+  glm::mat4 u_modelViewProjectionMatrix;
+
+  // Samplers
+  Sampler2DSoft<RGBA> *u_albedoMap;
+};
+
+struct ShaderVaryings {
+  glm::vec2 v_texCoord;
+};
+
+class ShaderTex : public ShaderSoft {
+ public:
+  CREATE_SHADER_OVERRIDE
+
+  std::vector<std::string> &getDefines() override {
+    static std::vector<std::string> defines;
+    return defines;
+  }
+
+  std::vector<UniformDesc> &getUniformsDesc() override {
+    static std::vector<UniformDesc> desc = {
+        {"UniformsTex", offsetof(ShaderUniforms, u_modelViewProjectionMatrix)},
+        {"u_albedoMap", offsetof(ShaderUniforms, u_albedoMap)},
+    };
+    return desc;
+  };
+};
+
+class VS : public ShaderTex {
+ public:
+  CREATE_SHADER_CLONE(VS)
+
+  void shaderMain() override {
+    gl->Position = u->u_modelViewProjectionMatrix * glm::vec4(a->a_position, 1.0);
+    v->v_texCoord = glm::vec2(a->a_position) * 4.f;
+  }
+};
+
+class FS : public ShaderTex {
+ public:
+  CREATE_SHADER_CLONE(FS)
+
+  int getSamplerDerivativeOffset() const override {
+    return offsetof(ShaderVaryings, v_texCoord);
+  }
+
+  void shaderMain() override {
+    gl->FragColor = texture(u->u_albedoMap, v->v_texCoord);
+  }
+};
+
+}
+
+// every operator new of this binary is counted, including std containers & std::function inside the renderer
+static std::atomic<size_t> gNewCount{0};
+
+void *operator new(std::size_t size) {
+  gNewCount.fetch_add(1, std::memory_order_relaxed);
+  void *ptr = size <= PTRDIFF_MAX ? std::malloc(size ? size : 1) : nullptr;
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void *operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  gNewCount.fetch_add(1, std::memory_order_relaxed);
+  return std::malloc(size ? size : 1);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  return operator new(size, std::nothrow);
+}
+
+void operator delete(void *ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+// steady state frames must not allocate, neither through operator new nor through MemoryUtils (buffers, arena blocks)
+static bool testSteadyStateAllocs(bool multiSample) {
+  auto renderer = std::make_shared<RendererSoft>();
+  renderer->create();
+
+  TextureDesc texDesc{};
+  texDesc.width = TEST_SIZE;
+  texDesc.height = TEST_SIZE;
+  texDesc.type = TextureType_2D;
+  texDesc.format = TextureFormat_RGBA8;
+  texDesc.usage = TextureUsage_AttachmentColor | TextureUsage_RendererOutput;
+  texDesc.multiSample = multiSample;
+  auto color = renderer->createTexture(texDesc);
+  color->initImageData();
+
+  texDesc.format = TextureFormat_FLOAT32;
+  texDesc.usage = TextureUsage_AttachmentDepth;
+  auto depth = renderer->createTexture(texDesc);
+  depth->initImageData();
+
+  auto fbo = renderer->createFrameBuffer(true);
+  fbo->setColorAttachment(color, 0);
+  fbo->setDepthAttachment(depth);
+
+  // sphere grid, enough vertexes for parallel vertex shading
+  const int n = 48;
+  std::vector<ShaderBasic::ShaderAttributes> vertexes;
+  std::vector<int32_t> indices;
+  for (int j = 0; j <= n; j++) {
+    for (int i = 0; i <= n; i++) {
+      float theta = (float) i / n * 2.f * glm::pi<float>();
+      float phi = (float) j / n * glm::pi<float>();
+      ShaderBasic::ShaderAttributes attr{};
+      attr.a_position = glm::vec3(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta));
+      vertexes.push_back(attr);
+    }
+  }
+  for (int j = 0; j < n; j++) {
+    for (int i = 0; i < n; i++) {
+      int a = j * (n + 1) + i;
+      int c = a + n + 1;
+      indices.insert(indices.end(), {a, c, a + 1, a + 1, c, c + 1});
+    }
+  }
+
+  VertexArray vertexArray;
+  vertexArray.vertexSize = sizeof(ShaderBasic::ShaderAttributes);
+  vertexArray.vertexesDesc.push_back({3, vertexArray.vertexSize, 0});
+  vertexArray.vertexesBuffer = (uint8_t *) vertexes.data();
+  vertexArray.vertexesBufferLength = vertexes.size() * vertexArray.vertexSize;
+  vertexArray.indexBuffer = indices.data();
+  vertexArray.indexBufferLength = indices.size() * sizeof(int32_t);
+  auto vao = renderer->createVertexArrayObject(vertexArray);
+
+  auto program = renderer->createShaderProgram();
+  dynamic_cast<ShaderProgramSoft *>(program.get())->SetShaders(std::make_shared<ShaderBasic::VS>(),
+                                                               std::make_shared<ShaderBasic::FS>());
+  auto uniformModel = renderer->createUniformBlock("UniformsModel", sizeof(UniformsModel));
+  auto uniformMaterial = renderer->createUniformBlock("UniformsMaterial", sizeof(UniformsMaterial));
+  auto resources = std::make_shared<ShaderResources>();
+  resources->blocks[UniformBlock_Model] = uniformModel;
+  resources->blocks[UniformBlock_Material] = uniformMaterial;
+
+  // opaque fill, blended fill, wireframe, points
+  RenderStates renderStates{};
+  renderStates.depthTest = true;
+  renderStates.depthMask = true;
+  renderStates.depthFunc = DepthFunc_LESS;
+  renderStates.cullFace = true;
+  renderStates.primitiveType = Primitive_TRIANGLE;
+  renderStates.polygonMode = PolygonMode_FILL;
+  renderStates.lineWidth = 1.f;
+  std::shared_ptr<PipelineStates> pipelineStates[4];
+  pipelineStates[0] = renderer->createPipelineStates(renderStates);
+
+  renderStates.blend = true;
+  renderStates.blendParams.SetBlendFactor(BlendFactor_SRC_ALPHA, BlendFactor_ONE_MINUS_SRC_ALPHA);
+  renderStates.depthMask = false;
+  pipelineStates[1] = renderer->createPipelineStates(renderStates);
+
+  renderStates.blend = false;
+  renderStates.depthFunc = DepthFunc_LEQUAL;
+  renderStates.polygonMode = PolygonMode_LINE;
+  pipelineStates[2] = renderer->createPipelineStates(renderStates);
+
+  renderStates.polygonMode = PolygonMode_POINT;
+  pipelineStates[3] = renderer->createPipelineStates(renderStates);
+
+  auto query = renderer->createQuery();
+
+  // textured draw
+  TextureDesc albedoDesc{};
+  albedoDesc.width = TEST_TEX_SIZE;
+  albedoDesc.height = TEST_TEX_SIZE;
+  albedoDesc.type = TextureType_2D;
+  albedoDesc.format = TextureFormat_RGBA8;
+  albedoDesc.usage = TextureUsage_Sampler | TextureUsage_UploadData;
+  albedoDesc.useMipmaps = true;
+  auto albedo = renderer->createTexture(albedoDesc);
+  SamplerDesc samplerDesc{};
+  samplerDesc.filterMin = Filter_LINEAR_MIPMAP_LINEAR;
+  samplerDesc.filterMag = Filter_LINEAR;
+  samplerDesc.wrapS = Wrap_REPEAT;
+  samplerDesc.wrapT = Wrap_REPEAT;
+  albedo->setSamplerDesc(samplerDesc);
+  auto albedoData = Buffer<RGBA>::makeDefault(TEST_TEX_SIZE, TEST_TEX_SIZE);
+  for (int y = 0; y < TEST_TEX_SIZE; y++) {
+    for (int x = 0; x < TEST_TEX_SIZE; x++) {
+      uint8_t c = ((x / 8 + y / 8) & 1) ? 255 : 0;
+      albedoData->set(x, y, RGBA(c, c, c, 255));
+    }
+  }
+  albedo->setImageData({albedoData});
+
+  auto texProgram = renderer->createShaderProgram();
+  dynamic_cast<ShaderProgramSoft *>(texProgram.get())->SetShaders(std::make_shared<ShaderTex::VS>(),
+                                                                  std::make_shared<ShaderTex::FS>());
+  auto uniformTex = renderer->createUniformBlock("UniformsTex", sizeof(glm::mat4));
+  auto uniformAlbedo = renderer->createUniformSampler("u_albedoMap", albedoDesc);
+  uniformAlbedo->setTexture(albedo);
+  auto texResources = std::make_shared<ShaderResources>();
+  texResources->blocks[0] = uniformTex;
+  texResources->samplers[0] = uniformAlbedo;
+
+  glm::mat4 proj = glm::perspective(glm::radians(60.f), 1.f, 0.1f, 100.f);
+  glm::mat4 view = glm::lookAt(glm::vec3(0, 0, 3), glm::vec3(0), glm::vec3(0, 1, 0));
+
+  size_t allocCount = 0;
+  size_t newCount = 0;
+  for (int frame = 0; frame < TEST_FRAMES; frame++) {
+    if (frame == TEST_WARMUP_FRAMES) {
+      allocCount = MemoryUtils::getAllocCount();
+      newCount = gNewCount.load(std::memory_order_relaxed);
+    }
+
+    ClearStates clearStates{};
+    clearStates.colorFlag = true;
+    clearStates.depthFlag = true;
+    clearStates.clearDepth = 1.f;
+    renderer->beginRenderPass(fbo, clearStates);
+    renderer->setViewPort(0, 0, TEST_SIZE, TEST_SIZE);
+    renderer->beginQuery(query);
+    for (int k = 0; k < 4; k++) {
+      UniformsModel model{};
+      model.u_modelMatrix = glm::translate(glm::mat4(1.f), glm::vec3((float) k - 1.5f, 0.f, -0.5f * (float) k));
+      model.u_modelViewProjectionMatrix = proj * view * model.u_modelMatrix;
+      uniformModel->setData(&model, sizeof(UniformsModel));
+
+      UniformsMaterial material{};
+      material.u_baseColor = glm::vec4(0.3f * (float) k, 0.5f, 1.f, 0.5f);
+      uniformMaterial->setData(&material, sizeof(UniformsMaterial));
+
+      renderer->setVertexArrayObject(vao);
+      renderer->setShaderProgram(program);
+      renderer->setShaderResources(resources);
+      renderer->setPipelineStates(pipelineStates[k]);
+      renderer->draw();
+    }
+
+    glm::mat4 mvp = proj * view * glm::translate(glm::mat4(1.f), glm::vec3(0.f, 1.f, 0.5f));
+    uniformTex->setData(&mvp, sizeof(glm::mat4));
+    renderer->setVertexArrayObject(vao);
+    renderer->setShaderProgram(texProgram);
+    renderer->setShaderResources(texResources);
+    renderer->setPipelineStates(pipelineStates[0]);
+    renderer->draw();
+    renderer->endQuery(query);
+    renderer->endRenderPass();
+    renderer->waitIdle();
+
+    uint64_t samples = 0;
+    if (!renderer->getQueryResult(query, samples) || samples == 0) {
+      fprintf(stderr, "FAILED msaa %d: no samples passed\n", multiSample);
+      return false;
+    }
+  }
+
+  size_t frameAllocs = MemoryUtils::getAllocCount() - allocCount;
+  size_t frameNews = gNewCount.load(std::memory_order_relaxed) - newCount;
+  if (frameAllocs != 0 || frameNews != 0) {
+    fprintf(stderr, "FAILED msaa %d: %zu buffer allocations, %zu operator new in %d steady state frames\n",
+            multiSample, frameAllocs, frameNews, TEST_FRAMES - TEST_WARMUP_FRAMES);
+    return false;
+  }
+  printf("PASSED msaa %d: no allocations in %d steady state frames\n", multiSample, TEST_FRAMES - TEST_WARMUP_FRAMES);
+  return true;
+}
+
+int main() {
+  bool passed = testSteadyStateAllocs(false);
+  passed = testSteadyStateAllocs(true) && passed;
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+/*
+ * SoftGLRender
+ * @author 	: keith@robot9.me
+ *
+ */
+
+#include <cstdio>
+#include "Render/Software/RendererSoft.h"
+#include "Render/Software/SamplerSoft.h"
+#include "Viewer/Material.h"
+#include "Viewer/Shader/Software/BasicSoft.h"
+
+using namespace SoftGL;
+using namespace SoftGL::View;
+
+#define TEST_SIZE 16
+#define TEST_DRAW_CNT 2
+
+// hdr color blended (ONE, ONE) into a float attachment, then sampled back through the texture sampler:
+// values above 1 must survive both blending and filtering.
+// triangle covers lower-left half, scissor keeps the checked area inside it, away from any shared edge
+template<typename T>
+static bool testBlendSample(TextureFormat format, const char *name, const glm::vec4 &expected, float tolerance) {
+  auto renderer = std::make_shared<RendererSoft>();
+  renderer->create();
+
+  TextureDesc texDesc{};
+  texDesc.width = TEST_SIZE;
+  texDesc.height = TEST_SIZE;
+  texDesc.type = TextureType_2D;
+  texDesc.format = format;
+  texDesc.usage = TextureUsage_AttachmentColor | TextureUsage_Sampler;
+  texDesc.multiSample = false;
+  auto color = renderer->createTexture(texDesc);
+  color->initImageData();
+
+  auto fbo = renderer->createFrameBuffer(true);
+  fbo->setColorAttachment(color, 0);
+
+  ShaderBasic::ShaderAttributes vertexes[3]{};
+  vertexes[0].a_position = {-1.f, -1.f, 0.f};
+  vertexes[1].a_position = {1.f, -1.f, 0.f};
+  vertexes[2].a_position = {-1.f, 1.f, 0.f};
+  int32_t indices[3] = {0, 1, 2};
+
+  VertexArray vertexArray;
+  vertexArray.vertexSize = sizeof(ShaderBasic::ShaderAttributes);
+  vertexArray.vertexesDesc.push_back({3, vertexArray.vertexSize, 0});
+  vertexArray.vertexesBuffer = (uint8_t *) vertexes;
+  vertexArray.vertexesBufferLength = sizeof(vertexes);
+  vertexArray.indexBuffer = indices;
+  vertexArray.indexBufferLength = sizeof(indices);
+  auto vao = renderer->createVertexArrayObject(vertexArray);
+
+  auto program = renderer->createShaderProgram();
+  dynamic_cast<ShaderProgramSoft *>(program.get())->SetShaders(std::make_shared<ShaderBasic::VS>(),
+                                                               std::make_shared<ShaderBasic::FS>());
+  UniformsModel model{};
+  model.u_modelMatrix = glm::mat4(1.f);
+  model.u_modelViewProjectionMatrix = glm::mat4(1.f);
+  auto uniformModel = renderer->createUniformBlock("UniformsModel", sizeof(UniformsModel));
+  uniformModel->setData(&model, sizeof(UniformsModel));
+  UniformsMaterial material{};
+  material.u_baseColor = glm::vec4(1.5f, 0.25f, 4.f, 1.f);
+  auto uniformMaterial = renderer->createUniformBlock("UniformsMaterial", sizeof(UniformsMaterial));
+  uniformMaterial->setData(&material, sizeof(UniformsMaterial));
+  auto resources = std::make_shared<ShaderResources>();
+  resources->blocks[UniformBlock_Model] = uniformModel;
+  resources->blocks[UniformBlock_Material] = uniformMaterial;
+
+  RenderStates renderStates{};
+  renderStates.cullFace = false;
+  renderStates.primitiveType = Primitive_TRIANGLE;
+  renderStates.polygonMode = PolygonMode_FILL;
+  renderStates.scissorTest = true;
+  renderStates.scissor.width = TEST_SIZE / 2;
+  renderStates.scissor.height = TEST_SIZE / 2;
+  renderStates.blend = true;
+  renderStates.blendParams.SetBlendFactor(BlendFactor_ONE, BlendFactor_ONE);
+  renderStates.blendParams.SetBlendFunc(BlendFunc_ADD);
+  auto pipelineStates = renderer->createPipelineStates(renderStates);
+
+  ClearStates clearStates{};
+  clearStates.colorFlag = true;
+  clearStates.clearColor = glm::vec4(0.f);
+  renderer->beginRenderPass(fbo, clearStates);
+  renderer->setViewPort(0, 0, TEST_SIZE, TEST_SIZE);
+  for (int i = 0; i < TEST_DRAW_CNT; i++) {
+    renderer->setVertexArrayObject(vao);
+    renderer->setShaderProgram(program);
+    renderer->setShaderResources(resources);
+    renderer->setPipelineStates(pipelineStates);
+    renderer->draw();
+  }
+  renderer->endRenderPass();
+  renderer->waitIdle();
+
+  // bilinear sample at texel centers & between texels of scissor area
+  auto *buffer = dynamic_cast<TextureSoft<T> *>(color.get())->getImage().getBuffer(0)->buffer.get();
+  float maxError = 0.f;
+  for (int y = 0; y <= 2 * (TEST_SIZE / 2 - 1); y++) {
+    for (int x = 0; x <= 2 * (TEST_SIZE / 2 - 1); x++) {
+      glm::vec2 uv((0.5f + 0.5f * (float) x) / TEST_SIZE, (0.5f + 0.5f * (float) y) / TEST_SIZE);
+      glm::vec4 ret = BaseSampler<T>::template sampleBilinear<LinearIndex, WrapClampEdge>(buffer, uv, glm::ivec2(0),
+                                                                                          glm::vec4(0.f));
+      glm::vec4 diff = glm::abs(ret - expected);
+      maxError = std::max(maxError, std::max(std::max(diff.x, diff.y), std::max(diff.z, diff.w)));
+    }
+  }
+
+  if (maxError > tolerance) {
+    fprintf(stderr, "FAILED %s: max error %f > %f\n", name, maxError, tolerance);
+    return false;
+  }
+  printf("PASSED %s: max error %f\n", name, maxError);
+  return true;
+}
+
+int main() {
+  // 2 draws of (1.5, 0.25, 4, 1)
+  glm::vec4 hdr(3.f, 0.5f, 8.f, 2.f);
+  bool passed = testBlendSample<RGBA16F>(TextureFormat_RGBA16F, "RGBA16F", hdr, 1e-3f);
+  passed = testBlendSample<RGBA32F>(TextureFormat_RGBA32F, "RGBA32F", hdr, 1e-6f) && passed;
+  // unorm attachment clamps, each of the 2 draws is quantized to 8 bit
+  passed = testBlendSample<RGBA>(TextureFormat_RGBA8, "RGBA8", glm::vec4(1.f, 0.5f, 1.f, 1.f), 2.f / 255.f) && passed;
+  return passed ? 0 : 1;
+}
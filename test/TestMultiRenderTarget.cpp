@@ -0,0 +1,173 @@
+/*
+ * SoftGLRender
+ * @author 	: keith@robot9.me
+ *
+ */
+
+#include <cstdio>
+#include "Render/Software/RendererSoft.h"
+#include "Render/Software/TextureSoft.h"
+
+using namespace SoftGL;
+
+#define TEST_SIZE 64
+
+namespace ShaderMRT {
+
+struct ShaderDefines {
+};
+
+struct ShaderAttributes {
+  glm::vec3 a_position;
+};
+
+struct ShaderUniforms {
+  // UniformsMRT
+  glm::vec4 u_color0;
+  glm::vec4 u_color1;
+};
+
+struct ShaderVaryings {
+};
+
+class ShaderMRT : public ShaderSoft {
+ public:
+  CREATE_SHADER_OVERRIDE
+
+  std::vector<std::string> &getDefines() override {
+    static std::vector<std::string> defines;
+    return defines;
+  }
+
+  std::vector<UniformDesc> &getUniformsDesc() override {
+    static std::vector<UniformDesc> desc = {
+        {"UniformsMRT", offsetof(ShaderUniforms, u_color0)},
+    };
+    return desc;
+  };
+};
+
+class VS : public ShaderMRT {
+ public:
+  CREATE_SHADER_CLONE(VS)
+
+  void shaderMain() override {
+    gl->Position = glm::vec4(a->a_position, 1.0);
+  }
+};
+
+class FS : public ShaderMRT {
+ public:
+  CREATE_SHADER_CLONE(FS)
+
+  int getFragDataCount() override { return 2; }
+
+  void shaderMain() override {
+    gl->FragData[0] = u->u_color0;
+    gl->FragData[1] = u->u_color1;
+  }
+};
+
+}
+
+static RGBA readPixel(std::shared_ptr<Texture> &tex, int x, int y) {
+  auto *texSoft = dynamic_cast<TextureSoft<RGBA> *>(tex.get());
+  return *texSoft->getImage().getBuffer(0)->buffer->get(x, y);
+}
+
+static bool checkPixel(std::shared_ptr<Texture> &tex, int attachment, int x, int y, RGBA expected) {
+  RGBA pixel = readPixel(tex, x, y);
+  if (pixel != expected) {
+    fprintf(stderr, "FAILED attachment %d (%d, %d): got (%d, %d, %d, %d), expected (%d, %d, %d, %d)\n",
+            attachment, x, y, pixel.r, pixel.g, pixel.b, pixel.a, expected.r, expected.g, expected.b, expected.a);
+    return false;
+  }
+  return true;
+}
+
+// quad over left half of a 2-attachment fbo, each attachment gets its own FragData output
+static bool testTwoAttachments() {
+  auto renderer = std::make_shared<RendererSoft>();
+  renderer->create();
+
+  TextureDesc texDesc{};
+  texDesc.width = TEST_SIZE;
+  texDesc.height = TEST_SIZE;
+  texDesc.type = TextureType_2D;
+  texDesc.format = TextureFormat_RGBA8;
+  texDesc.usage = TextureUsage_AttachmentColor | TextureUsage_Sampler;
+  texDesc.multiSample = false;
+  std::shared_ptr<Texture> colors[2];
+  for (auto &color : colors) {
+    color = renderer->createTexture(texDesc);
+    color->initImageData();
+  }
+
+  auto fbo = renderer->createFrameBuffer(true);
+  fbo->setColorAttachment(0, colors[0], 0);
+  fbo->setColorAttachment(1, colors[1], 0);
+  if (fbo->getColorAttachmentCount() != 2) {
+    fprintf(stderr, "FAILED color attachment count: %d\n", fbo->getColorAttachmentCount());
+    return false;
+  }
+
+  ShaderMRT::ShaderAttributes vertexes[4] = {
+      {{-1.f, -1.f, 0.f}}, {{0.f, -1.f, 0.f}}, {{-1.f, 1.f, 0.f}}, {{0.f, 1.f, 0.f}},
+  };
+  int32_t indices[6] = {0, 1, 2, 2, 1, 3};
+
+  VertexArray vertexArray;
+  vertexArray.vertexSize = sizeof(ShaderMRT::ShaderAttributes);
+  vertexArray.vertexesDesc.push_back({3, vertexArray.vertexSize, 0});
+  vertexArray.vertexesBuffer = (uint8_t *) vertexes;
+  vertexArray.vertexesBufferLength = sizeof(vertexes);
+  vertexArray.indexBuffer = indices;
+  vertexArray.indexBufferLength = sizeof(indices);
+  auto vao = renderer->createVertexArrayObject(vertexArray);
+
+  auto program = renderer->createShaderProgram();
+  dynamic_cast<ShaderProgramSoft *>(program.get())->SetShaders(std::make_shared<ShaderMRT::VS>(),
+                                                               std::make_shared<ShaderMRT::FS>());
+  ShaderMRT::ShaderUniforms uniforms{};
+  uniforms.u_color0 = glm::vec4(1.f, 0.f, 0.f, 1.f);
+  uniforms.u_color1 = glm::vec4(0.f, 1.f, 1.f, 1.f);
+  auto uniformBlock = renderer->createUniformBlock("UniformsMRT", sizeof(ShaderMRT::ShaderUniforms));
+  uniformBlock->setData(&uniforms, sizeof(ShaderMRT::ShaderUniforms));
+  auto resources = std::make_shared<ShaderResources>();
+  resources->blocks[0] = uniformBlock;
+
+  RenderStates renderStates{};
+  renderStates.cullFace = false;
+  renderStates.primitiveType = Primitive_TRIANGLE;
+  renderStates.polygonMode = PolygonMode_FILL;
+  auto pipelineStates = renderer->createPipelineStates(renderStates);
+
+  ClearStates clearStates{};
+  clearStates.colorFlag = true;
+  clearStates.clearColor = glm::vec4(0.f);
+  renderer->beginRenderPass(fbo, clearStates);
+  renderer->setViewPort(0, 0, TEST_SIZE, TEST_SIZE);
+  renderer->setVertexArrayObject(vao);
+  renderer->setShaderProgram(program);
+  renderer->setShaderResources(resources);
+  renderer->setPipelineStates(pipelineStates);
+  renderer->draw();
+  renderer->endRenderPass();
+  renderer->waitIdle();
+
+  int inX = TEST_SIZE / 4;
+  int outX = TEST_SIZE * 3 / 4;
+  int y = TEST_SIZE / 2;
+  bool passed = checkPixel(colors[0], 0, inX, y, RGBA(255, 0, 0, 255));
+  passed = checkPixel(colors[1], 1, inX, y, RGBA(0, 255, 255, 255)) && passed;
+  passed = checkPixel(colors[0], 0, outX, y, RGBA(0, 0, 0, 0)) && passed;
+  passed = checkPixel(colors[1], 1, outX, y, RGBA(0, 0, 0, 0)) && passed;
+  if (passed) {
+    printf("PASSED: 2 color attachments written by FragData[0], FragData[1]\n");
+  }
+  return passed;
+}
+
+int main() {
+  return testTwoAttachments() ? 0 : 1;
+}
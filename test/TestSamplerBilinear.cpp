@@ -0,0 +1,84 @@
+/*
+ * SoftGLRender
+ * @author 	: keith@robot9.me
+ *
+ */
+
+#include <cstdio>
+#include <random>
+#include "Render/Software/SamplerSoft.h"
+
+using namespace SoftGL;
+
+#define TEST_SIZE 64
+#define TEST_SAMPLES 100000
+// RGBA8 bilinear (16 bit fixed point with SOFTGL_SIMD_OPT) against double precision reference
+#define TEST_MAX_ERROR 2e-4
+
+typedef BaseSampler<RGBA> SamplerRGBA;
+
+template<typename W>
+static glm::dvec4 fetchReference(Buffer<RGBA> *buffer, int x, int y, const glm::dvec4 &border) {
+  if (!W::wrap(x, (int) buffer->getWidth()) || !W::wrap(y, (int) buffer->getHeight())) {
+    return border;
+  }
+  return glm::dvec4(*buffer->get(x, y)) / 255.0;
+}
+
+template<typename W>
+static glm::dvec4 sampleReference(Buffer<RGBA> *buffer, glm::vec2 uv, const glm::dvec4 &border) {
+  glm::dvec2 pos = glm::dvec2(uv) * glm::dvec2(buffer->getWidth(), buffer->getHeight()) - 0.5;
+  glm::dvec2 base = glm::floor(pos);
+  glm::dvec2 f = pos - base;
+  int x = (int) base.x;
+  int y = (int) base.y;
+  glm::dvec4 top = glm::mix(fetchReference<W>(buffer, x, y, border), fetchReference<W>(buffer, x + 1, y, border), f.x);
+  glm::dvec4 bottom = glm::mix(fetchReference<W>(buffer, x, y + 1, border),
+                               fetchReference<W>(buffer, x + 1, y + 1, border), f.x);
+  return glm::mix(top, bottom, f.y);
+}
+
+template<typename L, typename W>
+static bool testBilinear(BufferLayout layout, const char *name) {
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<int> texelDist(0, 255);
+  std::uniform_real_distribution<float> uvDist(-0.2f, 1.2f);
+
+  auto buffer = Buffer<RGBA>::makeLayout(TEST_SIZE, TEST_SIZE, layout);
+  for (int y = 0; y < TEST_SIZE; y++) {
+    for (int x = 0; x < TEST_SIZE; x++) {
+      buffer->set(x, y, RGBA(texelDist(rng), texelDist(rng), texelDist(rng), texelDist(rng)));
+    }
+  }
+  // extreme neighbours: worst case for weight quantization
+  buffer->set(0, 0, RGBA(255, 255, 255, 255));
+  buffer->set(1, 0, RGBA(0, 0, 0, 0));
+
+  glm::vec4 border(0.2f, 0.4f, 0.6f, 1.f);
+  glm::dvec4 borderRef = glm::dvec4(TexelTraits<RGBA>::store(border)) / 255.0;
+  double maxError = 0;
+  for (int i = 0; i < TEST_SAMPLES; i++) {
+    glm::vec2 uv(uvDist(rng), uvDist(rng));
+    glm::dvec4 ret = glm::dvec4(SamplerRGBA::sampleBilinear<L, W>(buffer.get(), uv, glm::ivec2(0), border));
+    glm::dvec4 diff = glm::abs(ret - sampleReference<W>(buffer.get(), uv, borderRef));
+    maxError = std::max(maxError, std::max(std::max(diff.x, diff.y), std::max(diff.z, diff.w)));
+  }
+
+  if (maxError > TEST_MAX_ERROR) {
+    fprintf(stderr, "FAILED %s: max error %.6f > %.6f\n", name, maxError, TEST_MAX_ERROR);
+    return false;
+  }
+  printf("PASSED %s: max error %.6f\n", name, maxError);
+  return true;
+}
+
+int main() {
+  bool passed = testBilinear<LinearIndex, WrapRepeatPOT>(Layout_Linear, "linear repeat");
+  passed = testBilinear<LinearIndex, WrapMirrorPOT>(Layout_Linear, "linear mirror") && passed;
+  passed = testBilinear<LinearIndex, WrapClampEdge>(Layout_Linear, "linear clamp edge") && passed;
+  passed = testBilinear<LinearIndex, WrapClampBorder>(Layout_Linear, "linear clamp border") && passed;
+  passed = testBilinear<TiledIndex, WrapRepeatPOT>(Layout_Tiled, "tiled repeat") && passed;
+  passed = testBilinear<MortonIndex, WrapClampBorder>(Layout_Morton, "morton clamp border") && passed;
+  passed = testBilinear<AnyIndex, WrapRepeat>(Layout_Morton, "any repeat") && passed;
+  return passed ? 0 : 1;
+}
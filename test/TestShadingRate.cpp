@@ -0,0 +1,133 @@
+/*
+ * SoftGLRender
+ * @author 	: keith@robot9.me
+ *
+ */
+
+#include <cstdio>
+#include "Render/Software/RendererSoft.h"
+#include "Viewer/Material.h"
+#include "Viewer/Shader/Software/BasicSoft.h"
+
+using namespace SoftGL;
+using namespace SoftGL::View;
+
+#define TEST_SIZE 64
+#define TEST_TILE_SIZE 16
+
+struct ShadingRateCase {
+  const char *name;
+  ShadingRate drawRate;
+  bool useImage;
+  uint64_t expectInvocations;
+};
+
+// triangle covering lower-left half, scissor keeps 2x2 tiles fully inside it, so every quad is
+// complete and invocation count only depends on shading rate:
+// tile rates 2X2, 2X1 / 1X2, 1X1 -> 256 / 4 + 256 / 2 + 256 / 2 + 256 = 576 of 1024 pixels
+static bool testTileShadingRate() {
+  auto renderer = std::make_shared<RendererSoft>();
+  renderer->create();
+
+  TextureDesc texDesc{};
+  texDesc.width = TEST_SIZE;
+  texDesc.height = TEST_SIZE;
+  texDesc.type = TextureType_2D;
+  texDesc.format = TextureFormat_RGBA8;
+  texDesc.usage = TextureUsage_AttachmentColor | TextureUsage_Sampler;
+  texDesc.multiSample = false;
+  auto color = renderer->createTexture(texDesc);
+  color->initImageData();
+
+  auto fbo = renderer->createFrameBuffer(true);
+  fbo->setColorAttachment(color, 0);
+
+  ShaderBasic::ShaderAttributes vertexes[3]{};
+  vertexes[0].a_position = {-1.f, -1.f, 0.f};
+  vertexes[1].a_position = {1.f, -1.f, 0.f};
+  vertexes[2].a_position = {-1.f, 1.f, 0.f};
+  int32_t indices[3] = {0, 1, 2};
+
+  VertexArray vertexArray;
+  vertexArray.vertexSize = sizeof(ShaderBasic::ShaderAttributes);
+  vertexArray.vertexesDesc.push_back({3, vertexArray.vertexSize, 0});
+  vertexArray.vertexesBuffer = (uint8_t *) vertexes;
+  vertexArray.vertexesBufferLength = sizeof(vertexes);
+  vertexArray.indexBuffer = indices;
+  vertexArray.indexBufferLength = sizeof(indices);
+  auto vao = renderer->createVertexArrayObject(vertexArray);
+
+  auto program = renderer->createShaderProgram();
+  dynamic_cast<ShaderProgramSoft *>(program.get())->SetShaders(std::make_shared<ShaderBasic::VS>(),
+                                                               std::make_shared<ShaderBasic::FS>());
+  UniformsModel model{};
+  model.u_modelMatrix = glm::mat4(1.f);
+  model.u_modelViewProjectionMatrix = glm::mat4(1.f);
+  auto uniformModel = renderer->createUniformBlock("UniformsModel", sizeof(UniformsModel));
+  uniformModel->setData(&model, sizeof(UniformsModel));
+  UniformsMaterial material{};
+  material.u_baseColor = glm::vec4(1.f);
+  auto uniformMaterial = renderer->createUniformBlock("UniformsMaterial", sizeof(UniformsMaterial));
+  uniformMaterial->setData(&material, sizeof(UniformsMaterial));
+  auto resources = std::make_shared<ShaderResources>();
+  resources->blocks[UniformBlock_Model] = uniformModel;
+  resources->blocks[UniformBlock_Material] = uniformMaterial;
+
+  auto rateImage = std::make_shared<Buffer<uint8_t>>();
+  rateImage->create(TEST_SIZE / TEST_TILE_SIZE, TEST_SIZE / TEST_TILE_SIZE);
+  rateImage->setAll(ShadingRate_1X1);
+  rateImage->set(0, 0, ShadingRate_2X2);
+  rateImage->set(1, 0, ShadingRate_2X1);
+  rateImage->set(0, 1, ShadingRate_1X2);
+
+  ShadingRateCase cases[] = {
+      {"no rate image", ShadingRate_1X1, false, 1024},
+      {"rate image", ShadingRate_1X1, true, 576},
+      // per draw rate combined with tile rate by max
+      {"rate image & draw 2X2", ShadingRate_2X2, true, 256},
+  };
+
+  bool passed = true;
+  for (auto &c : cases) {
+    RenderStates renderStates{};
+    renderStates.cullFace = false;
+    renderStates.primitiveType = Primitive_TRIANGLE;
+    renderStates.polygonMode = PolygonMode_FILL;
+    renderStates.scissorTest = true;
+    renderStates.scissor.width = TEST_SIZE / 2;
+    renderStates.scissor.height = TEST_SIZE / 2;
+    renderStates.shadingRate = c.drawRate;
+    auto pipelineStates = renderer->createPipelineStates(renderStates);
+
+    renderer->setShadingRateImage(c.useImage ? rateImage : nullptr, TEST_TILE_SIZE);
+    renderer->resetFrameStatistics();
+
+    ClearStates clearStates{};
+    clearStates.colorFlag = true;
+    renderer->beginRenderPass(fbo, clearStates);
+    renderer->setViewPort(0, 0, TEST_SIZE, TEST_SIZE);
+    renderer->setVertexArrayObject(vao);
+    renderer->setShaderProgram(program);
+    renderer->setShaderResources(resources);
+    renderer->setPipelineStates(pipelineStates);
+    renderer->draw();
+    renderer->endRenderPass();
+    renderer->waitIdle();
+
+    auto *stats = renderer->getFrameStatistics();
+    if (stats->fragmentShaderInvocations != c.expectInvocations || stats->samplesWritten != 1024) {
+      fprintf(stderr, "FAILED %s: %llu invocations (expected %llu), %llu samples written (expected 1024)\n", c.name,
+              (unsigned long long) stats->fragmentShaderInvocations, (unsigned long long) c.expectInvocations,
+              (unsigned long long) stats->samplesWritten);
+      passed = false;
+      continue;
+    }
+    printf("PASSED %s: %llu invocations for 1024 pixels\n", c.name,
+           (unsigned long long) stats->fragmentShaderInvocations);
+  }
+  return passed;
+}
+
+int main() {
+  return testTileShadingRate() ? 0 : 1;
+}